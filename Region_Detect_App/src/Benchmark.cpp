@@ -0,0 +1,499 @@
+//
+//  Benchmark.cpp
+//  example_ofxUrgDevice
+//
+//
+
+#include "Benchmark.h"
+#include "BackgroundModel.h"
+#include "LineExtractor.h"
+#include "OccupancyGrid.h"
+#include "SpatialIndex.h"
+#include "ScanSegmenter.h"
+
+using namespace ofxUrg;
+
+namespace {
+    int const NumBeams = 1081;
+    int const NumPeople = 8;
+    int const NumCrowd = 120;
+    long const FrameMsec = 25;
+    float const PersonRadius = 200;
+    // an opening without an echo in the middle of the far wall [mm]
+    float const DoorWidth = 1000;
+    // a track farther than this from a person does not belong to the person [mm]
+    float const MatchDistance = 500;
+    // frames before the tracks are scored
+    int const Warmup = 20;
+    int const NumSensors = 8;
+    int const NumQueries = 1000;
+
+    // accuracy of the confirmed tracks against the true positions
+    struct TrackScore
+    {
+        double error;
+        int matched, lost, switches, ghosts, frames;
+        vector<int> owners;     // track id of each person
+
+        TrackScore(int n) : error(0), matched(0), lost(0), switches(0), ghosts(0), frames(0), owners(n, -1) {}
+
+        void add(vector<Track> const& tracks, vector<ofVec2f> const& truth)
+        {
+            vector<bool> used(tracks.size(), false);
+            for (int i=0; i<truth.size(); i++) {
+                int best = -1;
+                float best_distance = MatchDistance;
+                for (int k=0; k<tracks.size(); k++) {
+                    float d = tracks[k].position.distance(truth[i]);
+                    if (tracks[k].confirmed && d < best_distance) {
+                        best = k;
+                        best_distance = d;
+                    }
+                }
+                if (best < 0) {
+                    lost++;
+                    continue;
+                }
+                used[best] = true;
+                error += best_distance;
+                matched++;
+                if (owners[i] >= 0 && owners[i] != tracks[best].id) {
+                    switches++;
+                }
+                owners[i] = tracks[best].id;
+            }
+            for (int k=0; k<tracks.size(); k++) {
+                if (tracks[k].confirmed && !used[k]) ghosts++;
+            }
+            frames++;
+        }
+
+        string toString() const
+        {
+            return "error " + ofToString(matched ? error / matched : 0, 1) + " mm"
+                + ", lost " + ofToString(100.0 * lost / max(frames * (int)owners.size(), 1), 1) + " %"
+                + ", id switches " + ofToString(switches)
+                + ", ghosts " + ofToString((float)ghosts / max(frames, 1), 2) + "/frame";
+        }
+    };
+}
+
+Benchmark::Benchmark()
+:frames(400), noise(10), room_angle(7), timestamp(0)
+{
+}
+
+void Benchmark::setup(int _frames, float _noise, float _room_angle)
+{
+    frames = _frames;
+    noise = _noise;
+    room_angle = _room_angle;
+    room.set(-4000, -6000, 8000, 6500);
+
+    vector<float> angles(NumBeams);
+    for (int i=0; i<NumBeams; i++) {
+        angles[i] = ofDegToRad(-135 + 0.25 * i);
+    }
+    angle_table.reset(new AngleTable(angles, 0));
+    ranges.resize(NumBeams);
+}
+
+void Benchmark::run()
+{
+    report.clear();
+    runTracker();
+    runLineExtractor();
+    runOccupancyGrid();
+    runSpatialIndex();
+}
+
+void Benchmark::runTracker()
+{
+    trackScans();
+    trackCrowd(Tracker::Greedy);
+    trackCrowd(Tracker::Hungarian);
+}
+
+void Benchmark::trackScans()
+{
+    BackgroundModel background;
+    ScanSegmenter segmenter;
+    Tracker tracker;
+    UrgData data;
+
+    // learns the empty room first, as the app would
+    people.clear();
+    background.setup();
+    while (!background.isLearned()) {
+        scan(data);
+        background.update(data);
+    }
+    reset();
+
+    unsigned long long micros = 0;
+    TrackScore score(people.size());
+    vector<ofVec2f> truth(people.size());
+
+    for (int f=0; f<frames; f++) {
+        step(people);
+        scan(data);
+
+        unsigned long long start = ofGetElapsedTimeMicros();
+        background.update(data);
+        data.setValidMask(background.getForegroundRef());
+        segmenter.update(data);
+        tracker.addClusters(segmenter.getClustersRef());
+        tracker.update(data.getTimestamp());
+        micros += ofGetElapsedTimeMicros() - start;
+
+        if (f < Warmup) continue;
+
+        for (int i=0; i<people.size(); i++) {
+            // the clusters are on the visible half of the person, whose
+            // centroid is pi/4 of the radius nearer than the centre
+            truth[i] = toSensor(people[i].position);
+            truth[i] -= truth[i].getNormalized() * (PI / 4 * PersonRadius);
+        }
+        score.add(tracker.getTracksRef(), truth);
+    }
+
+    print("Tracker: " + ofToString(micros / 1000.0 / max(frames, 1), 3) + " ms/frame, "
+          + ofToString(NumPeople) + " people in the scans (BackgroundModel + ScanSegmenter + Tracker)");
+    print("  " + score.toString());
+}
+
+void Benchmark::trackCrowd(Tracker::Association association)
+{
+    // people on a grid, each walking around its own circle,
+    // measured directly with the range noise
+    vector<Person> crowd(NumCrowd);
+    int columns = 12;
+    float spacing = 1200;
+    ofSeedRandom(1);
+    for (int i=0; i<crowd.size(); i++) {
+        Person& person = crowd[i];
+        person.centre.set((i % columns) * spacing, (i / columns) * spacing);
+        person.radius = 400;
+        person.angle = ofRandom(TWO_PI);
+        person.angular_speed = ofRandom(600, 1000) / person.radius * (ofRandom(1) < 0.5 ? -1 : 1);
+    }
+
+    Tracker tracker;
+    tracker.setup(2 * NumCrowd);
+    tracker.setAssociation(association);
+
+    timestamp = 0;
+    unsigned long long micros = 0;
+    TrackScore score(crowd.size());
+    vector<ofVec2f> truth(crowd.size());
+
+    for (int f=0; f<frames; f++) {
+        step(crowd);
+        for (int i=0; i<crowd.size(); i++) {
+            truth[i] = crowd[i].position;
+        }
+
+        unsigned long long start = ofGetElapsedTimeMicros();
+        for (int i=0; i<crowd.size(); i++) {
+            tracker.addMeasurement(truth[i] + ofVec2f(gaussian(), gaussian()) * noise);
+        }
+        tracker.update(timestamp);
+        micros += ofGetElapsedTimeMicros() - start;
+
+        if (f >= Warmup) score.add(tracker.getTracksRef(), truth);
+    }
+
+    print("Tracker: " + ofToString(micros / 1000.0 / max(frames, 1), 3) + " ms/frame, "
+          + ofToString(NumCrowd) + " people measured directly ("
+          + (association == Tracker::Hungarian ? "Hungarian" : "Greedy") + ")");
+    print("  " + score.toString());
+}
+
+void Benchmark::runLineExtractor()
+{
+    LineExtractor extractor;
+    UrgData data;
+    people.clear();
+
+    // the walls of the room, x * cos(alpha) + y * sin(alpha) = r
+    ofVec2f normals[4] = { ofVec2f(-1, 0), ofVec2f(1, 0), ofVec2f(0, -1), ofVec2f(0, 1) };
+    float distances[4] = { -room.x, room.x + room.width, -room.y, room.y + room.height };
+    float alphas[4];
+    for (int k=0; k<4; k++) {
+        ofVec2f n = toSensor(normals[k]);
+        alphas[k] = atan2(n.y, n.x);
+    }
+    ofVec2f corners[4] = {
+        toSensor(ofVec2f(room.x, room.y)), toSensor(ofVec2f(room.x + room.width, room.y)),
+        toSensor(ofVec2f(room.x, room.y + room.height)), toSensor(ofVec2f(room.x + room.width, room.y + room.height))
+    };
+
+    unsigned long long micros = 0;
+    double alpha_error = 0, r_error = 0, corner_error = 0, wall_angle_error = 0;
+    int num_segments = 0, num_corners = 0, unmatched = 0, through_door = 0;
+
+    for (int f=0; f<frames; f++) {
+        scan(data);
+
+        unsigned long long start = ofGetElapsedTimeMicros();
+        extractor.update(data);
+        micros += ofGetElapsedTimeMicros() - start;
+
+        vector<LineSegment> const& segments = extractor.getSegmentsRef();
+        for (int i=0; i<segments.size(); i++) {
+            // the wall with the same normal, which the segment lies on
+            int wall = -1;
+            float best = ofDegToRad(10);
+            for (int k=0; k<4; k++) {
+                float d = segments[i].alpha - alphas[k];
+                d = fabs(atan2(sin(d), cos(d)));
+                if (d < best && fabs(segments[i].r - distances[k]) < MatchDistance) {
+                    wall = k;
+                    best = d;
+                }
+            }
+            if (wall < 0) {
+                unmatched++;
+                continue;
+            }
+            alpha_error += best;
+            r_error += fabs(segments[i].r - distances[wall]);
+            num_segments++;
+
+            // the far wall is two pieces, one segment must not bridge the door
+            ofVec2f begin = segments[i].begin.getRotated(-room_angle);
+            ofVec2f end = segments[i].end.getRotated(-room_angle);
+            if (wall == 2 && min(begin.x, end.x) < 0 && max(begin.x, end.x) > 0) {
+                through_door++;
+            }
+        }
+
+        vector<Corner> const& found = extractor.getCornersRef();
+        for (int i=0; i<found.size(); i++) {
+            float best = FLT_MAX;
+            for (int k=0; k<4; k++) {
+                best = min(best, found[i].position.distance(corners[k]));
+            }
+            corner_error += best;
+            num_corners++;
+        }
+
+        wall_angle_error += fabs(extractor.getWallAngle() - room_angle);
+    }
+
+    print("LineExtractor: " + ofToString(micros / 1000.0 / max(frames, 1), 3) + " ms/scan, "
+          + ofToString((float)num_segments / max(frames, 1), 1) + " wall segments, "
+          + ofToString((float)num_corners / max(frames, 1), 1) + " corners per scan");
+    print("  alpha error " + ofToString(ofRadToDeg(alpha_error / max(num_segments, 1)), 3) + " deg"
+          + ", r error " + ofToString(r_error / max(num_segments, 1), 1) + " mm"
+          + ", corner error " + ofToString(corner_error / max(num_corners, 1), 1) + " mm"
+          + ", wall angle error " + ofToString(wall_angle_error / max(frames, 1), 3) + " deg"
+          + ", off the walls " + ofToString(unmatched)
+          + ", through the door " + ofToString(through_door));
+}
+
+void Benchmark::runOccupancyGrid()
+{
+    int workers[] = { 0, 1, 2, 4, 8 };
+    for (int w=0; w<sizeof(workers) / sizeof(workers[0]); w++) {
+        OccupancyGrid grid;
+        grid.setup(50, workers[w]);
+        UrgData data;
+        reset();
+
+        unsigned long long micros = 0;
+        for (int f=0; f<frames; f++) {
+            step(people);
+            scan(data);
+
+            unsigned long long start = ofGetElapsedTimeMicros();
+            grid.update(data);
+            micros += ofGetElapsedTimeMicros() - start;
+        }
+
+        print("OccupancyGrid: " + ofToString(workers[w]) + " workers, "
+              + ofToString(grid.getNumBeams() / max(micros / 1.0e6, 1.0e-6) / 1.0e6, 2) + " M beams/s"
+              + ", " + ofToString(grid.getNumTiles()) + " tiles, "
+              + ofToString(grid.getNumCutBeams()) + " cut beams");
+    }
+}
+
+void Benchmark::runSpatialIndex()
+{
+    // the room with the people seen by 8 sensors, placed as if fused
+    // by ofxUrgManager: each copy of the scan turned by 45 degree
+    UrgData data;
+    reset();
+    scan(data);
+    vector<ofVec2f> points;
+    vector<int> const& indices = data.getValidIndicesRef();
+    for (int s=0; s<NumSensors; s++) {
+        for (int k=0; k<indices.size(); k++) {
+            points.push_back(data.getPoint(indices[k]).getRotated(s * 360.0 / NumSensors));
+        }
+    }
+
+    // queries inside and around the points
+    float extent = 9000;
+    float radius = 300;
+    float max_distance = 1000;
+    int k = 5;
+    vector<ofVec2f> queries(NumQueries);
+    for (int i=0; i<queries.size(); i++) {
+        queries[i].set(ofRandom(-extent, extent), ofRandom(-extent, extent));
+    }
+
+    SpatialIndex index;
+    unsigned long long build_micros = 0, grid_micros = 0, brute_micros = 0;
+    int mismatches = 0;
+    vector<int> result, expected;
+    vector<pair<float, int> > distances(points.size());
+
+    for (int f=0; f<frames; f++) {
+        unsigned long long start = ofGetElapsedTimeMicros();
+        index.build(points);
+        build_micros += ofGetElapsedTimeMicros() - start;
+
+        // only the first frame is checked, the others are timed
+        if (f > 0) {
+            start = ofGetElapsedTimeMicros();
+            for (int q=0; q<queries.size(); q++) {
+                index.findWithin(queries[q], radius, result);
+                index.findNearest(queries[q], k, result);
+                index.findNearest(queries[q], max_distance);
+            }
+            grid_micros += ofGetElapsedTimeMicros() - start;
+            continue;
+        }
+
+        for (int q=0; q<queries.size(); q++) {
+            ofVec2f const& p = queries[q];
+            start = ofGetElapsedTimeMicros();
+            expected.clear();
+            for (int i=0; i<points.size(); i++) {
+                distances[i] = make_pair(points[i].distance(p), i);
+                if (distances[i].first <= radius) expected.push_back(i);
+            }
+            partial_sort(distances.begin(), distances.begin() + min(k, (int)points.size()), distances.end());
+            brute_micros += ofGetElapsedTimeMicros() - start;
+
+            // within the radius: the same ids
+            index.findWithin(p, radius, result);
+            sort(result.begin(), result.end());
+            if (result != expected) mismatches++;
+
+            // nearest: the same distances, ties may be in another order
+            index.findNearest(p, k, result);
+            bool same = result.size() == min(k, (int)points.size());
+            for (int i=0; same && i<result.size(); i++) {
+                same = points[result[i]].distance(p) == distances[i].first;
+            }
+            if (!same) mismatches++;
+
+            int nearest = index.findNearest(p, max_distance);
+            if (distances[0].first <= max_distance
+                ? nearest < 0 || points[nearest].distance(p) != distances[0].first
+                : nearest >= 0) {
+                mismatches++;
+            }
+        }
+    }
+
+    print("SpatialIndex: " + ofToString(points.size()) + " points, build "
+          + ofToString(build_micros / 1000.0 / max(frames, 1), 3) + " ms, "
+          + ofToString(NumQueries) + " x (radius, " + ofToString(k) + "-nearest, nearest) "
+          + ofToString(grid_micros / 1000.0 / max(frames - 1, 1), 3) + " ms");
+    print("  brute force " + ofToString(brute_micros / 1000.0, 3) + " ms for the "
+          + ofToString(NumQueries) + " queries, mismatches " + ofToString(mismatches));
+}
+
+void Benchmark::reset()
+{
+    // the same scene every run
+    ofSeedRandom(1);
+    timestamp = 0;
+    people.resize(NumPeople);
+    for (int i=0; i<people.size(); i++) {
+        Person& person = people[i];
+        person.radius = ofRandom(500, 1500);
+        float margin = person.radius + 2 * PersonRadius;
+        // keeps clear of the sensor
+        do {
+            person.centre.set(ofRandom(room.x + margin, room.x + room.width - margin),
+                              ofRandom(room.y + margin, room.y + room.height - margin));
+        } while (person.centre.length() < margin + 500);
+        person.angle = ofRandom(TWO_PI);
+        person.angular_speed = ofRandom(800, 1500) / person.radius * (ofRandom(1) < 0.5 ? -1 : 1);
+    }
+    step(people);
+}
+
+void Benchmark::step(vector<Person>& persons)
+{
+    timestamp += FrameMsec;
+    for (int i=0; i<persons.size(); i++) {
+        Person& person = persons[i];
+        person.angle += person.angular_speed * FrameMsec / 1000.0;
+        person.position = person.centre + ofVec2f(cos(person.angle), sin(person.angle)) * person.radius;
+    }
+}
+
+void Benchmark::scan(UrgData& data)
+{
+    vector<float> const& cosines = angle_table->getCosRef();
+    vector<float> const& sines = angle_table->getSinRef();
+    for (int i=0; i<NumBeams; i++) {
+        // the direction of the beam in the room
+        ofVec2f direction = ofVec2f(cosines[i], -sines[i]).getRotated(-room_angle);
+        float range = cast(direction);
+        ranges[i] = range > 0 ? range + noise * gaussian() : 0;
+    }
+    data.setData(ranges);
+    data.setAngleTable(angle_table);
+    data.updateValidMask(20, 30000);
+    data.setTimestamp(timestamp);
+}
+
+float Benchmark::cast(ofVec2f const& direction) const
+{
+    // the sensor is inside the room, so the beam leaves it once on each axis
+    float t = FLT_MAX;
+    if (direction.x > 0) t = min(t, (room.x + room.width) / direction.x);
+    if (direction.x < 0) t = min(t, room.x / direction.x);
+    if (direction.y > 0) t = min(t, (room.y + room.height) / direction.y);
+    if (direction.y < 0) t = min(t, room.y / direction.y);
+    ofVec2f hit = direction * t;
+    if (fabs(hit.y - room.y) < 1 && fabs(hit.x) < DoorWidth / 2) {
+        t = FLT_MAX;
+    }
+
+    for (int i=0; i<people.size(); i++) {
+        ofVec2f const& c = people[i].position;
+        float b = direction.dot(c);
+        float d2 = c.squareLength() - b * b;
+        float r2 = PersonRadius * PersonRadius;
+        if (b > 0 && d2 < r2) {
+            t = min(t, b - sqrt(r2 - d2));
+        }
+    }
+    return t < FLT_MAX ? t : 0;
+}
+
+ofVec2f Benchmark::toSensor(ofVec2f const& p) const
+{
+    return p.getRotated(room_angle);
+}
+
+float Benchmark::gaussian()
+{
+    // Box-Muller
+    float u = ofRandom(FLT_EPSILON, 1);
+    float v = ofRandom(1);
+    return sqrt(-2 * log(u)) * cos(TWO_PI * v);
+}
+
+void Benchmark::print(string const& line)
+{
+    ofLogNotice("Benchmark") << line;
+    report += line + "\n";
+}
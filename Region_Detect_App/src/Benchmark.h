@@ -0,0 +1,86 @@
+//
+//  Benchmark.h
+//  example_ofxUrgDevice
+//
+//
+
+#ifndef __example_ofxUrgDevice__Benchmark__
+#define __example_ofxUrgDevice__Benchmark__
+
+#include "ofMain.h"
+#include "UrgData.h"
+#include "Tracker.h"
+
+// runs the processing of the addon on synthetic scans, so that its speed
+// and accuracy can be checked without a sensor. the scene is a rectangular
+// room with a door in the far wall, rotated by room_angle around the sensor,
+// with people walking around circles in it. it is scanned at 40Hz by a sensor at the origin with
+// 1081 beams over 270 degree, like a UTM-30LX.
+class Benchmark
+{
+public:
+    Benchmark();
+
+    // frames: scans per test, noise: sigma of the range noise [mm],
+    // room_angle: rotation of the room [degree]
+    void setup(int frames = 400, float noise = 10, float room_angle = 7);
+
+    // runs every test and logs the results
+    void run();
+    // tracking: time per frame, position error, lost people, id switches
+    // and tracks without a person. once through the scans of the room, and
+    // once for a crowd of 120 people measured directly, with each association.
+    void runTracker();
+    // lines and corners of the empty room: time per scan, errors of the
+    // segments against the walls, of the corners, and of getWallAngle(),
+    // and the segments that bridge the door
+    void runLineExtractor();
+    // raycasting throughput of the scans with the people, in beams per
+    // second, with 0 (the calling thread) to 8 workers
+    void runOccupancyGrid();
+    // radius, k-nearest and nearest queries against brute force over the
+    // scan seen by 8 sensors: build and query time, and the queries whose
+    // results differ from brute force
+    void runSpatialIndex();
+
+    string const& getReport() const { return report; }
+
+private:
+    // walks around a circle in the room [mm]
+    struct Person
+    {
+        ofVec2f centre;
+        float radius;
+        float angle;            // [rad]
+        float angular_speed;    // [rad/s]
+        ofVec2f position;
+    };
+
+    void trackScans();
+    void trackCrowd(ofxUrg::Tracker::Association association);
+
+    void reset();
+    void step(vector<Person>& persons);
+    void scan(ofxUrg::UrgData& data);
+    // distance to the first wall or person along the direction in the room,
+    // 0 through the door
+    float cast(ofVec2f const& direction) const;
+    // the position in the coordinates of UrgData::getXsRef()
+    ofVec2f toSensor(ofVec2f const& p) const;
+    float gaussian();
+    void print(string const& line);
+
+    int frames;
+    float noise;
+    float room_angle;
+    ofRectangle room;
+    vector<Person> people;
+    long timestamp;
+
+    ofxUrg::AngleTablePtr angle_table;
+    vector<long> ranges;
+
+    string report;
+};
+
+#endif /* defined(__example_ofxUrgDevice__Benchmark__) */
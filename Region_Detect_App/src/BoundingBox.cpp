@@ -39,6 +39,7 @@ void BoundingBox::registerBox()
         return;
     }
     registered_boxes.push_back(bounding_box);
+    compiled_dirty = true;
 }
 
 void BoundingBox::drawRegisteredBoxes() const
@@ -54,7 +55,7 @@ void BoundingBox::drawRegisteredBoxes() const
     }
 }
 
-bool isInside(float x, float y, ofRectangle r)
+ofRectangle normalized(ofRectangle r)
 {
     if (r.width < 0) {
         r.x += r.width;
@@ -64,45 +65,78 @@ bool isInside(float x, float y, ofRectangle r)
         r.y += r.height;
         r.height *= -1;
     }
-    
-    if (r.x > x) return false;
-    if (x > r.x+r.width) return false;
-    if (r.y > y) return false;
-    if (y > r.y+r.height) return false;
-    
-    return true;
+    return r;
+}
+
+// clips [t_min, t_max] of the ray t * dir to the slab lower <= t * dir <= upper
+void clipSlab(float dir, float lower, float upper, float& t_min, float& t_max)
+{
+    if (fabs(dir) < 1e-6) {
+        if (lower > 0 || 0 > upper) {
+            t_min = 1;
+            t_max = 0;
+        }
+        return;
+    }
+    float t1 = lower / dir;
+    float t2 = upper / dir;
+    t_min = max(t_min, min(t1, t2));
+    t_max = min(t_max, max(t1, t2));
 }
 
-set<int> BoundingBox::hitCheck(ofxUrg::UrgData const& data)
+void BoundingBox::compile(ofxUrg::UrgData const& data)
 {
-    set<int> indices;
-    float offset = ofDegToRad(data.getSensorAngle() + 90);
+    vector<float> const& cosines = data.getCosRef();
+    vector<float> const& sines = data.getSinRef();
+    
+    compiled.assign(registered_boxes.size(), vector<BeamRange>());
+    for (int j=0; j<registered_boxes.size(); j++) {
+        ofRectangle r = normalized(registered_boxes[j]);
+        for (int i=0; i<cosines.size(); i++) {
+            // the beam of the sensor at the origin, in screen coordinates
+            BeamRange range = { i, 0, FLT_MAX };
+            clipSlab( cosines[i], r.x, r.x + r.width,  range.near_distance, range.far_distance);
+            clipSlab(-sines[i],   r.y, r.y + r.height, range.near_distance, range.far_distance);
+            if (range.near_distance <= range.far_distance) {
+                compiled[j].push_back(range);
+            }
+        }
+    }
+    compiled_table = data.getAngleTable();
+    compiled_dirty = false;
+}
 
-    for (int i=0; i<data.size(); i++) {
-        float x =  data.getDataRef()[i] * cos(data.getDataAnglesRef()[i] + offset);
-        float y = -data.getDataRef()[i] * sin(data.getDataAnglesRef()[i] + offset);
-        
-        for (int j=0; j<registered_boxes.size(); j++) {
-            bool hit = isInside(x, y, registered_boxes[j]);
-            
-            if (isInside(x, y, registered_boxes[j])) {
-                indices.insert(j);
+ofxUrg::BeamMask const& BoundingBox::hitCheck(ofxUrg::UrgData const& data)
+{
+    if (compiled_dirty || compiled_table != data.getAngleTable()) {
+        compile(data);
+    }
+    
+    hits.resize(registered_boxes.size());
+    vector<long> const& ranges = data.getDataRef();
+    for (int j=0; j<compiled.size(); j++) {
+        vector<BeamRange> const& beams = compiled[j];
+        for (int k=0; k<beams.size(); k++) {
+            int i = beams[k].beam;
+            if (i >= ranges.size()) break;
+            if (beams[k].near_distance <= ranges[i] && ranges[i] <= beams[k].far_distance && data.isValid(i)) {
+                hits.set(j);
+                break;
             }
         }
     }
-    return indices;
+    return hits;
 }
 
-void BoundingBox::drawHitRegion(set<int> idx) const
+void BoundingBox::drawHitRegion(ofxUrg::BeamMask const& hits) const
 {
     ofPushStyle();
     ofSetLineWidth(3);
     ofNoFill();
 
-    set<int>::iterator it;
-    for (it=idx.begin(); it!=idx.end(); ++it) {
-        ofSetColor(ofColor::fromHsb(((int) (*it)*60 + 40) % 256, 255, 255));
-        ofRect(registered_boxes[*it]);
+    for (int j=hits.next(0); j>=0; j=hits.next(j+1)) {
+        ofSetColor(ofColor::fromHsb(((int) j*60 + 40) % 256, 255, 255));
+        ofRect(registered_boxes[j]);
     }
     
     ofPopStyle();
@@ -11,11 +11,13 @@
 
 #include "ofMain.h"
 #include "UrgData.h"
-#include <set>
+#include "BeamMask.h"
 
 class BoundingBox
 {
 public:
+    BoundingBox() : compiled_dirty(true) {}
+    
     void mouseDragged(int x, int y, int button);
     void mousePressed(int x, int y, int button);
     void mouseReleased(int x, int y, int button);
@@ -23,15 +25,33 @@ public:
     ofRectangle const& getBox() const;
     void registerBox();
 
-    inline void clear() { registered_boxes.clear(); }
+    inline void clear() { registered_boxes.clear(); compiled_dirty = true; }
     void drawRegisteredBoxes() const;
-    void drawHitRegion(set<int> idx) const;
+    void drawHitRegion(ofxUrg::BeamMask const& hits) const;
     
-    set<int> hitCheck(ofxUrg::UrgData const& data);
+    // bit j is set when a valid beam hits the registered box j
+    ofxUrg::BeamMask const& hitCheck(ofxUrg::UrgData const& data);
     
 private:
+    // range of distances of a beam inside a box
+    struct BeamRange
+    {
+        int beam;
+        float near_distance;
+        float far_distance;
+    };
+    
+    void compile(ofxUrg::UrgData const& data);
+    
     ofRectangle bounding_box;
     vector<ofRectangle> registered_boxes;
+    
+    // beams crossing each registered box, rebuilt when the boxes or the
+    // angle table (sensor angle) change
+    vector<vector<BeamRange> > compiled;
+    ofxUrg::AngleTablePtr compiled_table;
+    bool compiled_dirty;
+    ofxUrg::BeamMask hits;
 };
 
 #endif /* defined(__example_ofxUrgDevice__BoundingBox__) */
@@ -16,6 +16,7 @@ void testApp::setup(){
     ofEnableAlphaBlending();
     
     urg.setup();
+    benchmark.setup();
     
     guisetup();
 }
@@ -35,7 +36,7 @@ void testApp::update(){
         clear_region = false;
     }
     
-    hit_indices = box.hitCheck(urg.getData());
+    hit_indices = box.hitCheck(*urg.getSnapshot());
 
 }
 
@@ -74,6 +75,9 @@ void testApp::draw(){
                        mouseX, mouseY);
     ofPopStyle();
     
+    // Benchmark Result
+    ofDrawBitmapString(benchmark.getReport(), 220, 20);
+    
     
 }
 
@@ -112,6 +116,10 @@ void testApp::keyPressed(int key){
     if (key == ' ') {
         register_region = true;
     }
+    // runs on the synthetic scans, no sensor is needed
+    if (key == 'b') {
+        benchmark.run();
+    }
 }
 
 //--------------------------------------------------------------
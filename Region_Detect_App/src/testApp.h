@@ -5,7 +5,7 @@
 #include "ofxUI.h"
 
 #include "BoundingBox.h"
-#include <set>
+#include "Benchmark.h"
 
 class testApp : public ofBaseApp{
 
@@ -26,6 +26,8 @@ class testApp : public ofBaseApp{
     
     BoundingBox box;
     
-    set<int> hit_indices;
+    ofxUrg::BeamMask hit_indices;
+    
+    Benchmark benchmark;
 		
 };
@@ -0,0 +1,89 @@
+#ifndef QRK_CAPTURE_STATISTICS_H
+#define QRK_CAPTURE_STATISTICS_H
+
+/*!
+  \file
+  \brief Counters of the capture stream
+*/
+
+#include <cstddef>
+
+
+namespace qrk
+{
+  /*!
+    \brief Counters of the capture stream
+
+    A snapshot is taken by UrgDevice::statistics(). The difference of two
+    snapshots gives the counters and the transfer rate of the interval.
+
+    \code
+CaptureStatistics previous = urg.statistics();
+...
+CaptureStatistics current = urg.statistics();
+CaptureStatistics interval = current.diff(previous);
+printf("%.1f [%%]\n", interval.linkUtilization()); \endcode
+  */
+  class CaptureStatistics
+  {
+  public:
+    size_t received_scans;      //!< Scans stored to the buffer
+    size_t dropped_scans;       //!< Scans overwritten before capture()
+    size_t checksum_errors;     //!< Lines with a checksum error
+    size_t resyncs;             //!< Waits for the next echo back
+    size_t restarts;            //!< Capture commands issued again
+    size_t reconnects;          //!< Reconnection attempts
+    size_t received_bytes;      //!< Bytes of the capture responses
+    long baudrate;              //!< Negotiated baudrate [bps]
+    double begin_ticks;         //!< Start of the counting [msec]
+    double end_ticks;           //!< Time of the snapshot [msec]
+
+
+    CaptureStatistics(void);
+
+    void clear(double ticks);
+
+
+    /*!
+      \brief Counters from the previous snapshot to this snapshot
+
+      When the counters were cleared in between, by clearStatistics() or
+      a reconnection, the interval starts at the clear instead of
+      wrapping around.
+
+      \param[in] previous snapshot taken before this one
+
+      \return counters of the interval
+    */
+    CaptureStatistics diff(const CaptureStatistics& previous) const;
+
+
+    /*!
+      \brief Length of the counted interval
+
+      \return interval [msec]
+    */
+    double elapsedMsec(void) const;
+
+
+    /*!
+      \brief Received bytes per second
+
+      \return transfer rate [byte/sec]
+    */
+    double bytesPerSecond(void) const;
+
+
+    /*!
+      \brief Ratio of the transfer rate to the link capacity
+
+      The capacity is baudrate / 10 [byte/sec], start and stop bits
+      included. The value is meaningless for USB and Ethernet devices.
+
+      \return utilization [%]
+    */
+    double linkUtilization(void) const;
+  };
+}
+
+#endif /* !QRK_CAPTURE_STATISTICS_H */
@@ -10,6 +10,14 @@
 #include "ticks.h"
 #include "system_ticks.h"
 #include "MonitorModeManager.h"
+#include "DetectOS.h"
+#if defined(WINDOWS_OS)
+#include <windows.h>
+#elif defined(MAC_OS)
+#include <mach/mach_time.h>
+#else
+#include <time.h>
+#endif
 
 
 long qrk::ticks(void)
@@ -39,3 +47,29 @@ long qrk::ticks(void)
     return system_ticks();
   }
 }
+
+
+double qrk::preciseTicks(void)
+{
+#if defined(WINDOWS_OS)
+  static LARGE_INTEGER frequency;
+  if (frequency.QuadPart == 0) {
+    QueryPerformanceFrequency(&frequency);
+  }
+  LARGE_INTEGER counter;
+  QueryPerformanceCounter(&counter);
+  return 1000.0 * counter.QuadPart / frequency.QuadPart;
+
+#elif defined(MAC_OS)
+  static mach_timebase_info_data_t timebase;
+  if (timebase.denom == 0) {
+    mach_timebase_info(&timebase);
+  }
+  return mach_absolute_time() * (timebase.numer / (timebase.denom * 1000000.0));
+
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec * 1000.0) + (now.tv_nsec / 1000000.0);
+#endif
+}
@@ -20,6 +20,16 @@ namespace qrk
       \retval ^CX^v [msec]
     */
     extern long ticks(void);
+
+
+    /*!
+      \brief Monotonic timestamp with sub-millisecond resolution
+
+      Used to measure latency. The origin is not specified.
+
+      \retval timestamp [msec]
+    */
+    extern double preciseTicks(void);
 }
 
 #endif /* !QRK_TICKS_H */
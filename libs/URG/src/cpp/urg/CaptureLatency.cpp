@@ -0,0 +1,110 @@
+/*!
+  \file
+  \brief Latency statistics of the capture pipeline
+*/
+
+#include "CaptureLatency.h"
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+using namespace qrk;
+using namespace std;
+
+
+CaptureLatency::CaptureLatency(void)
+{
+  clear();
+}
+
+
+void CaptureLatency::clear(void)
+{
+  memset(counts_, 0, sizeof(counts_));
+  memset(total_, 0, sizeof(total_));
+  fill(sum_, sum_ + StageSize, 0.0);
+  fill(square_sum_, square_sum_ + StageSize, 0.0);
+  fill(max_, max_ + StageSize, 0.0);
+}
+
+
+int CaptureLatency::bucket(double usec)
+{
+  if (usec < 1.0) {
+    return 0;
+  }
+
+  // usec = fraction * 2^exponent, 0.5 <= fraction < 1.0
+  int exponent = 0;
+  double fraction = frexp(usec, &exponent);
+  int index = ((exponent - 1) * SubBuckets) +
+    static_cast<int>(((fraction * 2.0) - 1.0) * SubBuckets);
+
+  return min(index, static_cast<int>(Buckets) - 1);
+}
+
+
+double CaptureLatency::bucketValue(int index)
+{
+  // upper bound of the bucket [msec]
+  int octave = index / SubBuckets;
+  int sub = index % SubBuckets;
+  return ldexp(1.0 + ((sub + 1.0) / SubBuckets), octave) / 1000.0;
+}
+
+
+void CaptureLatency::add(Stage stage, double msec)
+{
+  if (msec < 0.0) {
+    msec = 0.0;
+  }
+  ++counts_[stage][bucket(msec * 1000.0)];
+  ++total_[stage];
+  sum_[stage] += msec;
+  square_sum_[stage] += msec * msec;
+  max_[stage] = max(max_[stage], msec);
+}
+
+
+double CaptureLatency::percentile(Stage stage, double ratio) const
+{
+  size_t target = static_cast<size_t>(ceil(total_[stage] * ratio));
+  size_t accumulated = 0;
+  for (int i = 0; i < Buckets; ++i) {
+    accumulated += counts_[stage][i];
+    if ((accumulated > 0) && (accumulated >= target)) {
+      return min(bucketValue(i), max_[stage]);
+    }
+  }
+  return max_[stage];
+}
+
+
+CaptureLatency::Summary CaptureLatency::summary(Stage stage) const
+{
+  Summary summary;
+  summary.count = total_[stage];
+  if (summary.count == 0) {
+    return summary;
+  }
+
+  summary.mean = sum_[stage] / total_[stage];
+  summary.p50 = percentile(stage, 0.50);
+  summary.p99 = percentile(stage, 0.99);
+  summary.max = max_[stage];
+
+  return summary;
+}
+
+
+double CaptureLatency::jitter(void) const
+{
+  size_t n = total_[FrameInterval];
+  if (n < 2) {
+    return 0.0;
+  }
+
+  double mean = sum_[FrameInterval] / n;
+  double variance = (square_sum_[FrameInterval] / n) - (mean * mean);
+  return (variance > 0.0) ? sqrt(variance) : 0.0;
+}
@@ -0,0 +1,99 @@
+#ifndef QRK_CAPTURE_LATENCY_H
+#define QRK_CAPTURE_LATENCY_H
+
+/*!
+  \file
+  \brief Latency statistics of the capture pipeline
+*/
+
+#include <cstddef>
+
+
+namespace qrk
+{
+  /*!
+    \brief Latency histograms of each capture stage
+
+    Values are stored in log-scaled buckets (8 buckets per octave from
+    1 [usec]), so that percentiles are within about 10% of the real value
+    and adding a sample costs only a few operations.
+  */
+  class CaptureLatency
+  {
+  public:
+    //! Measured interval
+    typedef enum {
+      Receive,                  //!< First byte arrival -> frame complete
+      Decode,                   //!< Frame complete -> decode done
+      Enqueue,                  //!< Decode done -> stored in the buffer
+      Dequeue,                  //!< Stored in the buffer -> taken by capture()
+      EndToEnd,                 //!< First byte arrival -> taken by capture()
+      FrameInterval,            //!< Between frame completes
+      StageSize,
+    } Stage;
+
+    //! Summary of a stage [msec]
+    class Summary
+    {
+    public:
+      size_t count;             //!< Number of samples
+      double mean;              //!< Mean
+      double p50;               //!< Median
+      double p99;               //!< 99th percentile
+      double max;               //!< Maximum
+
+      Summary(void) : count(0), mean(0.0), p50(0.0), p99(0.0), max(0.0)
+      {
+      }
+    };
+
+    CaptureLatency(void);
+
+    void clear(void);
+
+
+    /*!
+      \brief Add a sample
+
+      \param[in] stage measured stage
+      \param[in] msec interval [msec]
+    */
+    void add(Stage stage, double msec);
+
+
+    /*!
+      \brief Statistics of the stage
+
+      \param[in] stage measured stage
+      \return statistics [msec]
+    */
+    Summary summary(Stage stage) const;
+
+
+    /*!
+      \brief Standard deviation of FrameInterval
+
+      \return jitter [msec]
+    */
+    double jitter(void) const;
+
+  private:
+    enum {
+      SubBuckets = 8,
+      Octaves = 25,             // 1 [usec] - 33 [sec]
+      Buckets = SubBuckets * Octaves,
+    };
+
+    static int bucket(double usec);
+    static double bucketValue(int index);
+    double percentile(Stage stage, double ratio) const;
+
+    size_t counts_[StageSize][Buckets];
+    size_t total_[StageSize];
+    double sum_[StageSize];
+    double square_sum_[StageSize];
+    double max_[StageSize];
+  };
+}
+
+#endif /* !QRK_CAPTURE_LATENCY_H */
@@ -46,12 +46,18 @@ namespace qrk
     int skip_frames;            //!< Data acquisition interval
     int remain_times;           //!< Remaining number of  scans
     int data_byte;              //!< Number of data bytes
+    double first_byte_ticks;    //!< Arrival of the echo back [msec]
+    double complete_ticks;      //!< Arrival of the last line [msec]
+    int received_bytes;         //!< Number of received bytes
+    int checksum_errors;        //!< Number of lines with checksum error
 
 
     CaptureSettings(void)
       : type(TypeUnknown), error_code(-1), timestamp(-1),
         capture_first(-1), capture_last(-1),
-        skip_lines(-1), skip_frames(-1), remain_times(-1), data_byte(-1)
+        skip_lines(-1), skip_frames(-1), remain_times(-1), data_byte(-1),
+        first_byte_ticks(0.0), complete_ticks(0.0),
+        received_bytes(0), checksum_errors(0)
     {
     }
   };
@@ -0,0 +1,88 @@
+/*!
+  \file
+  \brief Counters of the capture stream
+*/
+
+#include "CaptureStatistics.h"
+
+using namespace qrk;
+
+
+namespace
+{
+  // 0 rather than a wrap around, if a counter went back anyway
+  size_t increase(size_t current, size_t previous)
+  {
+    return (current >= previous) ? (current - previous) : 0;
+  }
+}
+
+
+CaptureStatistics::CaptureStatistics(void) : baudrate(0)
+{
+  clear(0.0);
+}
+
+
+void CaptureStatistics::clear(double ticks)
+{
+  received_scans = 0;
+  dropped_scans = 0;
+  checksum_errors = 0;
+  resyncs = 0;
+  restarts = 0;
+  reconnects = 0;
+  received_bytes = 0;
+  begin_ticks = ticks;
+  end_ticks = ticks;
+  // baudrate is kept
+}
+
+
+CaptureStatistics CaptureStatistics::diff(const CaptureStatistics&
+                                          previous) const
+{
+  CaptureStatistics interval = *this;
+  if (begin_ticks > previous.end_ticks) {
+    // cleared after the previous snapshot, counted from the clear()
+    return interval;
+  }
+  interval.received_scans =
+    increase(received_scans, previous.received_scans);
+  interval.dropped_scans = increase(dropped_scans, previous.dropped_scans);
+  interval.checksum_errors =
+    increase(checksum_errors, previous.checksum_errors);
+  interval.resyncs = increase(resyncs, previous.resyncs);
+  interval.restarts = increase(restarts, previous.restarts);
+  interval.reconnects = increase(reconnects, previous.reconnects);
+  interval.received_bytes =
+    increase(received_bytes, previous.received_bytes);
+  interval.begin_ticks = previous.end_ticks;
+
+  return interval;
+}
+
+
+double CaptureStatistics::elapsedMsec(void) const
+{
+  return end_ticks - begin_ticks;
+}
+
+
+double CaptureStatistics::bytesPerSecond(void) const
+{
+  double msec = elapsedMsec();
+  if (msec <= 0.0) {
+    return 0.0;
+  }
+  return received_bytes * 1000.0 / msec;
+}
+
+
+double CaptureStatistics::linkUtilization(void) const
+{
+  if (baudrate <= 0) {
+    return 0.0;
+  }
+  return 100.0 * bytesPerSecond() / (baudrate / 10.0);
+}
@@ -15,6 +15,7 @@
 #include "delay.h"
 #include "DetectOS.h"
 #include "log_printf.h"
+#include <algorithm>
 #include <cstring>
 #include <cstdio>
 
@@ -58,6 +59,8 @@ struct ScipHandler::pImpl
 
     BufferSize = 64 + 1 + 1,    // f[^ + `FbNT + s
 
+    DataLineSize = 64,          // [byte] of a data line but the last one
+
     ResponseTimeout = -1,
     MismatchResponse = -2,
     SendFail = -3,
@@ -421,14 +424,14 @@ struct ScipHandler::pImpl
       if (! parseGdEchoback(settings, line)) {
         return ProcessBreak;
       }
-      type = (line[1] = 'D') ? GD : GS;
+      type = (line[1] == 'D') ? GD : GS;
 
     } else if ((! line.compare(0, 2, "MD")) ||
                (! line.compare(0, 2, "MS"))) {
       if (! parseMdEchoback(settings, line)) {
         return ProcessBreak;
       }
-      type = (line[1] = 'D') ? MD : MS;
+      type = (line[1] == 'D') ? MD : MS;
       laser_state_ = LaserOn;
 
     } else if (! line.compare(0, 2, "ME")) {
@@ -439,6 +442,7 @@ struct ScipHandler::pImpl
       laser_state_ = LaserOn;
 
     } else if (! line.compare(0, 2, "QT")) {
+      type = QT;
       settings.remain_times = 0;
       laser_state_ = LaserOff;
       mx_capturing_ = false;
@@ -490,7 +494,8 @@ struct ScipHandler::pImpl
 
   CaptureType receiveCaptureData(vector<long>& data,
                                  CaptureSettings& settings, long* timestamp,
-                                 int* remain_times, int* total_times)
+                                 int* remain_times, int* total_times,
+                                 int first_timeout)
   {
     int line_count = 0;
     data.clear();
@@ -503,22 +508,61 @@ struct ScipHandler::pImpl
     error_message_ = "no response.";
 
     CaptureType type = TypeUnknown;
-    int timeout = FirstTimeout;
+    int timeout = (first_timeout > 0) ? first_timeout : FirstTimeout;
     int line_size = 0;
+    bool broken_line = false;
+    bool broken_next = false;
+    bool broken_last = false;
+    bool salvaged = false;
+    settings.received_bytes = 0;
+    settings.checksum_errors = 0;
     while ((line_size = readline(con_, buffer, BufferSize, timeout)) > 0) {
       //fprintf(stderr, "%d: % 3d: %s\n", ticks(), line_count, buffer);
+      settings.received_bytes += line_size + 1;
 
       // `FbNT̊mF
-      if (line_count != 0) {
+      if (line_count >= 3) {
+        // A broken data line invalidates only the beams stored in the line,
+        // if the line kept its length, so that the next lines stay aligned
+        broken_line = ! checkSum(buffer, line_size - 1, buffer[line_size - 1]);
+        if (broken_line) {
+          ++settings.checksum_errors;
+          log_printf("checksum error: %s\n", buffer);
+          error_message_ = "invalid packet.";
+        }
+        if (broken_last) {
+          // The short broken line was not the last one
+          clearReceived(data, type, line_count, timeout,
+                        remain_string, left_packet_data);
+          broken_next = false;
+          broken_last = false;
+          salvaged = false;
+          continue;
+        }
+        if (broken_line && (line_size - 1 != DataLineSize)) {
+          // Only the last line may be short. Decided by the next line.
+          broken_last = true;
+          salvaged = true;
+          ++line_count;
+          continue;
+        }
+        if (broken_line) {
+          salvaged = true;
+        }
+      } else if (line_count != 0) {
         // GR[obNɂ̓`FbNT񂪂Ȃ̂ŁA
         if (! testChecksum(buffer, line_size, data, type, line_count, timeout,
                            remain_string, left_packet_data)) {
+          ++settings.checksum_errors;
+          broken_next = false;
+          salvaged = false;
           continue;
         }
       }
 
       if (line_count == 0) {
         // GR[obN
+        settings.first_byte_ticks = preciseTicks();
         LoopProcess loop_process =
           handleEchoback(buffer, settings, type, data, line_count, timeout,
                          remain_string, left_packet_data);
@@ -550,13 +594,39 @@ struct ScipHandler::pImpl
           }
         }
         // f[^̊i[
+        size_t first_index = data.size();
         left_packet_data =
           addLengthData(data, string(buffer), left_packet_data,
                         settings.data_byte, settings.skip_lines);
+
+        if (broken_next) {
+          // The first value was continued from the broken line
+          size_t last_index = min(first_index + settings.skip_lines,
+                                  data.size());
+          fill(data.begin() + first_index, data.begin() + last_index,
+               static_cast<long>(InvalidRange));
+          broken_next = false;
+        }
+        if (broken_line) {
+          fill(data.begin() + first_index, data.end(),
+               static_cast<long>(InvalidRange));
+          broken_next = ! left_packet_data.empty();
+        }
       }
       ++line_count;
       timeout = ContinuousTimeout;
     }
+    if (line_size == 0) {
+      // the last empty line
+      ++settings.received_bytes;
+
+    } else if (broken_last) {
+      // The end of the short broken line is unknown
+      clearReceived(data, type, line_count, timeout,
+                    remain_string, left_packet_data);
+      salvaged = false;
+    }
+    settings.complete_ticks = preciseTicks();
 
     // !!! type f[^擾̂Ƃ́AɎMAmFׂ
 
@@ -564,6 +634,10 @@ struct ScipHandler::pImpl
     size_t expected_n = settings.capture_last * ((type == ME) ? 2 : 1);
     if (expected_n < data.size()) {
       data.erase(data.begin() + expected_n, data.end());
+
+    } else if (salvaged && (expected_n > data.size())) {
+      // The beams of the broken last line
+      data.resize(expected_n, InvalidRange);
     }
 
     if (remain_times) {
@@ -835,8 +909,9 @@ bool ScipHandler::setLaserOutput(bool on, bool force)
 CaptureType ScipHandler::receiveCaptureData(vector<long>& data,
                                             CaptureSettings& settings,
                                             long* timestamp, int* remain_times,
-                                            int* total_times)
+                                            int* total_times,
+                                            int first_timeout)
 {
-  return pimpl->receiveCaptureData(data, settings,
-                                   timestamp, remain_times, total_times);
+  return pimpl->receiveCaptureData(data, settings, timestamp, remain_times,
+                                   total_times, first_timeout);
 }
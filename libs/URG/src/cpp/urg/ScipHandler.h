@@ -59,10 +59,12 @@ namespace qrk
 
     bool setLaserOutput(bool on, bool force = false);
 
+    // first_timeout: [msec] to wait for the echo back, the default when 0
     CaptureType receiveCaptureData(std::vector<long>& data,
                                    CaptureSettings& settings, long* timestamp,
                                    int* remain_times = NULL,
-                                   int* total_times = NULL);
+                                   int* total_times = NULL,
+                                   int first_timeout = 0);
 
   private:
     ScipHandler(const ScipHandler& rhs);
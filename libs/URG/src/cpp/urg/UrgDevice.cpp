@@ -13,7 +13,9 @@
 #include "SerialDevice.h"
 #include "ScipHandler.h"
 #include "RangeSensorParameter.h"
+#include "ConnectionUtils.h"
 #include "ticks.h"
+#include "delay.h"
 #include "Thread.h"
 #include "LockGuard.h"
 #include "Lock.h"
@@ -35,7 +37,22 @@ namespace
 {
   enum {
     MdScansMax = 100,           // [times]
+
+    ResyncTimes = 2,            // [times]
+    ResyncScans = 2,            // [scans] without data to detect a dead stream
+    SkipTimeout = 100,          // [msec]
+    ReconnectDelayMin = 100,    // [msec]
+    ReconnectDelayMax = 3200,   // [msec]
+    ReconnectPollMsec = 10,     // [msec]
   };
+
+
+  typedef enum {
+    RecoverResync,              // keep receiving the current stream
+    RecoverRestart,             // issue the capture command again
+    RecoverWait,                // wait for the next reconnection
+    RecoverFailed,              // give up
+  } RecoverAction;
 }
 
 
@@ -46,8 +63,10 @@ struct UrgDevice::pImpl
     vector<long> length_data;
     long timestamp;
     CaptureSettings settings;
+    double decoded_ticks;
+    double enqueued_ticks;
 
-    ScanData(void) : timestamp(-1)
+    ScanData(void) : timestamp(-1), decoded_ticks(0.0), enqueued_ticks(0.0)
     {
     }
   };
@@ -89,7 +108,8 @@ struct UrgDevice::pImpl
       // !!! ł̑Mɂ́AMp[^̓ep
 
       char buffer[] = "GDbbbbeeeegg\n";
-      snprintf(buffer, strlen(buffer) + 1, "GD%04d%04d%02u\n",
+      snprintf(buffer, strlen(buffer) + 1, "G%c%04d%04d%02u\n",
+               (pimpl_->capture_data_byte_ == 2) ? 'S' : 'D',
                pimpl_->capture_begin_, pimpl_->capture_end_,
                pimpl_->capture_skip_lines_);
 
@@ -99,7 +119,20 @@ struct UrgDevice::pImpl
 
     int capture(vector<long>& data, long* timestamp)
     {
-      pimpl_->retry_times_ = 0;
+      data.clear();
+      if (pimpl_->currentStatus() == CaptureFailed) {
+        return -1;
+      }
+
+      if (pimpl_->currentStatus() == Reconnecting) {
+        // Do not block the caller while waiting for the next reconnection
+        RecoverAction action = pimpl_->recover();
+        if (action == RecoverFailed) {
+          return -1;
+        } else if (action == RecoverWait) {
+          return 0;
+        }
+      }
 
       // [U_Ă
       pimpl_->scip_.setLaserOutput(ScipHandler::On);
@@ -110,11 +143,31 @@ struct UrgDevice::pImpl
                                  static_cast<int>(command.size()));
       if (n != static_cast<int>(command.size())) {
         pimpl_->error_message_ = "Send command:" + command + " fail.";
-        return -1;
+        return (pimpl_->recover() == RecoverFailed) ? -1 : 0;
+      }
+
+      ScanData scan;
+      CaptureType type =
+        pimpl_->scip_.receiveCaptureData(data, scan.settings, timestamp, NULL);
+      {
+        LockGuard guard(pimpl_->mutex_);
+        pimpl_->countReceived(scan.settings);
+      }
+      if ((type != GD) && (type != GS)) {
+        // Discard the rest of the broken response before the next GD
+        data.clear();
+        skip(pimpl_->con_, SkipTimeout);
+        return (pimpl_->recover() == RecoverFailed) ? -1 : 0;
+      }
+      pimpl_->recovered();
+
+      LockGuard guard(pimpl_->mutex_);
+      ++pimpl_->statistics_.received_scans;
+      if (pimpl_->measure_latency_) {
+        pimpl_->recordReceived(scan);
+        pimpl_->recordDequeued(scan);
       }
 
-      CaptureSettings settings;
-      pimpl_->scip_.receiveCaptureData(data, settings, timestamp, NULL);
       return static_cast<int>(data.size());
     }
 
@@ -160,7 +213,8 @@ struct UrgDevice::pImpl
     string createCaptureCommand(void)
     {
       char buffer[] = "MDbbbbeeeeggstt\n";
-      snprintf(buffer, strlen(buffer) + 1, "MD%04d%04d%02u%01u%02u\n",
+      snprintf(buffer, strlen(buffer) + 1, "M%c%04d%04d%02u%01u%02u\n",
+               (pimpl_->capture_data_byte_ == 2) ? 'S' : 'D',
                pimpl_->capture_begin_, pimpl_->capture_end_,
                pimpl_->capture_skip_lines_,
                pimpl_->capture_frame_interval_,
@@ -174,13 +228,14 @@ struct UrgDevice::pImpl
 
     int capture(vector<long>& data, long* timestamp)
     {
-      if (pimpl_->retry_times_ > pimpl_->max_retry_times_) {
+      if (pimpl_->currentStatus() == CaptureFailed) {
         return -1;
       }
 
       // XbhN
       LockGuard guard(pimpl_->mutex_);
       if ((! pimpl_->thread_.isRunning()) && pimpl_->data_buffer_.empty()) {
+        pimpl_->stop_requested_ = false;
         pimpl_->thread_.run(1);
       }
 
@@ -197,6 +252,9 @@ struct UrgDevice::pImpl
         *timestamp = pimpl_->data_buffer_.front().timestamp;
         //fprintf(stderr, "MD: %ld, %ld\n", ticks(), *timestamp);
       }
+      if (pimpl_->measure_latency_) {
+        pimpl_->recordDequeued(pimpl_->data_buffer_.front());
+      }
       pimpl_->data_buffer_.pop_front();
 
       return static_cast<int>(data.size());
@@ -272,13 +330,14 @@ struct UrgDevice::pImpl
 
     int capture(vector<long>& data, long* timestamp)
     {
-      if (pimpl_->retry_times_ > pimpl_->max_retry_times_) {
+      if (pimpl_->currentStatus() == CaptureFailed) {
         return -1;
       }
 
       LockGuard guard(pimpl_->mutex_);
       // 擾ς݃f[^Ȃ΁AXbhN
       if ((! pimpl_->thread_.isRunning()) && pimpl_->data_buffer_.empty()) {
+        pimpl_->stop_requested_ = false;
         pimpl_->thread_.run(1);
       }
 
@@ -295,6 +354,9 @@ struct UrgDevice::pImpl
         *timestamp = pimpl_->data_buffer_.front().timestamp;
       }
       CaptureSettings settings = pimpl_->data_buffer_.front().settings;
+      if (pimpl_->measure_latency_) {
+        pimpl_->recordDequeued(pimpl_->data_buffer_.front());
+      }
       pimpl_->data_buffer_.pop_front();
       pimpl_->intensity_data_.timestamp = *timestamp;
       pimpl_->intensity_data_.length_data.clear();
@@ -373,6 +435,8 @@ struct UrgDevice::pImpl
 
   string error_message_;
   UrgDevice* parent_;
+  string device_;
+  long baudrate_;
   Connection* con_;
   SerialDevice* serial_; //!< LȐڑIuWFNgȂƂɗp
   ScipHandler scip_;
@@ -396,6 +460,7 @@ struct UrgDevice::pImpl
   int capture_end_;
   size_t capture_skip_lines_;
   int capture_skip_frames_;
+  size_t capture_data_byte_;
 
   size_t capture_frame_interval_;
   size_t capture_times_;
@@ -404,12 +469,38 @@ struct UrgDevice::pImpl
   size_t max_retry_times_;
   size_t retry_times_;
 
+  CaptureStatus status_;
+  void (*status_function_)(CaptureStatus status, void* args);
+  void* status_args_;
+  size_t failure_times_;
+  long reconnect_ticks_;
+  long reconnect_delay_;
+  bool stop_requested_;
+
+  bool measure_latency_;
+  CaptureLatency latency_;
+  double pre_complete_ticks_;
+  CaptureStatistics statistics_;
+
+  bool reconfigure_requested_;
+  bool reconfigure_sent_;
+  int next_capture_begin_;
+  int next_capture_end_;
+  size_t next_capture_skip_lines_;
+  size_t next_capture_frame_interval_;
+
   long base_timestamp_;
   long pre_timestamp_;
 
+  double angle_offset_;
+  vector<double> angle_table_;
+  vector<double> cos_table_;
+  vector<double> sin_table_;
+
 
   pImpl(UrgDevice* parent)
     : error_message_("no error."), parent_(parent),
+      device_(""), baudrate_(DefaultBaudrate),
       con_(NULL), serial_(NULL), urg_type_(""),
       recent_timestamp_(0), timestamp_offset_(0),
       capture_mode_(ManualCapture),
@@ -417,11 +508,18 @@ struct UrgDevice::pImpl
       intensity_capture_(this), capture_(&manual_capture_),
       thread_(&capture_thread, this),
       capture_begin_(0), capture_end_(0),
-      capture_skip_lines_(1), capture_skip_frames_(0),
+      capture_skip_lines_(1), capture_skip_frames_(0), capture_data_byte_(3),
       capture_frame_interval_(0), capture_times_(0),
       remain_times_(0), invalid_packet_(false),
       max_retry_times_(DefaultRetryTimes), retry_times_(0),
-      base_timestamp_(0), pre_timestamp_(0)
+      status_(Capturing), status_function_(NULL), status_args_(NULL),
+      failure_times_(0), reconnect_ticks_(0),
+      reconnect_delay_(ReconnectDelayMin), stop_requested_(false),
+      measure_latency_(false), pre_complete_ticks_(0.0),
+      reconfigure_requested_(false), reconfigure_sent_(false),
+      next_capture_begin_(0), next_capture_end_(0),
+      next_capture_skip_lines_(1), next_capture_frame_interval_(0),
+      base_timestamp_(0), pre_timestamp_(0), angle_offset_(0.0)
   {
   }
 
@@ -453,6 +551,17 @@ struct UrgDevice::pImpl
     }
     scip_.setConnection(con_);
 
+    device_ = device;
+    baudrate_ = baudrate;
+    {
+      LockGuard guard(mutex_);
+      statistics_.clear(preciseTicks());
+      statistics_.baudrate = baudrate;
+      failure_times_ = 0;
+      retry_times_ = 0;
+    }
+    setStatus(Capturing);
+
     // {[[goł̃foCXƂ̐ڑ
     if (! scip_.connect(device, baudrate)) {
       error_message_ = scip_.what();
@@ -477,6 +586,7 @@ struct UrgDevice::pImpl
       return false;
     }
     swap(parameters_, parameters);
+    updateAngleTable();
 
     size_t type_length = min(parameters_.model.find('('),
                              parameters_.model.find('['));
@@ -505,49 +615,253 @@ struct UrgDevice::pImpl
   }
 
 
+  // The tables cover every index up to area_max, so that they do not
+  // depend on the capture range.
+  void updateAngleTable(void)
+  {
+    if (parameters_.area_total <= 0) {
+      // the parameter is not loaded yet
+      angle_table_.clear();
+      cos_table_.clear();
+      sin_table_.clear();
+      return;
+    }
+
+    size_t n = parameters_.area_max + 1;
+    angle_table_.resize(n);
+    cos_table_.resize(n);
+    sin_table_.resize(n);
+
+    double step = (2.0 * M_PI) / parameters_.area_total;
+    for (size_t i = 0; i < n; ++i) {
+      double radian =
+        (static_cast<int>(i) - parameters_.area_front) * step;
+      angle_table_[i] = radian;
+      cos_table_[i] = cos(radian + angle_offset_);
+      sin_table_[i] = sin(radian + angle_offset_);
+    }
+  }
+
+
+  // The callback is called without mutex_, so that it can use the accessors
+  void setStatus(CaptureStatus status)
+  {
+    {
+      LockGuard guard(mutex_);
+      if (status == status_) {
+        return;
+      }
+      status_ = status;
+    }
+    if (status_function_) {
+      status_function_(status, status_args_);
+    }
+  }
+
+
+  CaptureStatus currentStatus(void)
+  {
+    LockGuard guard(mutex_);
+    return status_;
+  }
+
+
+  void recovered(void)
+  {
+    {
+      LockGuard guard(mutex_);
+      failure_times_ = 0;
+      retry_times_ = 0;
+    }
+    reconnect_delay_ = ReconnectDelayMin;
+    setStatus(Capturing);
+  }
+
+
+  // While MD/MS/ME is streaming, a scan arrives every frame interval
+  int resyncTimeout(void) const
+  {
+    int scan_rpm = parameters_.scan_rpm;
+    int scan_msec = (scan_rpm <= 0) ? 100 : (1000 * 60 / scan_rpm);
+    return ResyncScans * scan_msec *
+      static_cast<int>(capture_frame_interval_ + 1);
+  }
+
+
+  // Called for each broken packet or timeout.
+  // Escalates resync -> restart -> reconnect while the failure continues.
+  RecoverAction recover(void)
+  {
+    CaptureStatus status = currentStatus();
+    if (status == CaptureFailed) {
+      return RecoverFailed;
+    }
+
+    if (status != Reconnecting) {
+      size_t failure_times = 0;
+      {
+        LockGuard guard(mutex_);
+        failure_times = ++failure_times_;
+      }
+      if (failure_times <= ResyncTimes) {
+        // receiveCaptureData() skips lines until the next echo back
+        setStatus(Resyncing);
+        countRecovery(&CaptureStatistics::resyncs);
+        return RecoverResync;
+
+      } else if (failure_times == ResyncTimes + 1) {
+        // Stop the stream and discard the received data
+        setStatus(Restarting);
+        countRecovery(&CaptureStatistics::restarts);
+        if (capture_mode_ != ManualCapture) {
+          scip_.send("QT\n", 3);
+        }
+        // The echo back of a pending reconfiguration is skipped here
+        adoptReconfiguration();
+        skip(con_, SkipTimeout);
+        return RecoverRestart;
+      }
+
+      setStatus(Reconnecting);
+      reconnect_delay_ = ReconnectDelayMin;
+      reconnect_ticks_ = ticks();
+    }
+    return reconnect();
+  }
+
+
+  RecoverAction reconnect(void)
+  {
+    if (ticks() < reconnect_ticks_) {
+      return RecoverWait;
+    }
+
+    bool given_up = false;
+    {
+      LockGuard guard(mutex_);
+      given_up = (max_retry_times_ != Infinity) &&
+        (retry_times_ >= max_retry_times_);
+      if (! given_up) {
+        ++retry_times_;
+      }
+    }
+    if (given_up) {
+      error_message_ = "capture recovery was given up.";
+      setStatus(CaptureFailed);
+      return RecoverFailed;
+    }
+    countRecovery(&CaptureStatistics::reconnects);
+
+    con_->disconnect();
+    if (! scip_.connect(device_.c_str(), baudrate_)) {
+      error_message_ = scip_.what();
+      reconnect_ticks_ = ticks() + reconnect_delay_;
+      reconnect_delay_ = min(reconnect_delay_ * 2,
+                             static_cast<long>(ReconnectDelayMax));
+      return RecoverWait;
+    }
+
+    {
+      LockGuard guard(mutex_);
+      failure_times_ = 0;
+    }
+    adoptReconfiguration();
+    setStatus(Restarting);
+    return RecoverRestart;
+  }
+
+
+  bool sendCaptureCommand(void)
+  {
+    // ݒɊÂāAf[^MR}h쐬Ĕs
+    string capture_command = capture_->createCaptureCommand();
+    int n = scip_.send(capture_command.c_str(),
+                       static_cast<int>(capture_command.size()));
+    if (n != static_cast<int>(capture_command.size())) {
+      error_message_ = capture_command + " fail.";
+      return false;
+    }
+    return true;
+  }
+
+
   // AutoCapture, IntensityCapture ̃f[^擾s
   static int capture_thread(void* args)
   {
     pImpl* obj = static_cast<pImpl*>(args);
 
-    // ݒɊÂāAf[^MR}h쐬Ĕs
-    string capture_command = obj->capture_->createCaptureCommand();
-    if (capture_command.empty()) {
+    if (obj->capture_->createCaptureCommand().empty()) {
       // ̃G[ IntensityCapture ̂Ƃ̂ݔ̂Ɉˑ
       obj->error_message_ = "This urg is not support intensity capture.";
       return -1;
     }
-    int n = obj->scip_.send(capture_command.c_str(),
-                            static_cast<int>(capture_command.size()));
-    if (n != static_cast<int>(capture_command.size())) {
-      obj->error_message_ = capture_command + " fail.";
-      ++obj->retry_times_;
-      return -1;
-    }
+    // A failed send is detected as a timeout, and is recovered below
+    obj->sendCaptureCommand();
+    // The first scan after a command may take longer than the next ones
+    bool streaming = false;
 
     // M҂
     ScanData data;
     int remain_times = MdScansMax;
     int total_times = 0;
     while (1) {
+      if (obj->takeReconfiguration()) {
+        // Sent from this thread, not to interleave with the capture commands
+        obj->scip_.send("QT\n", 3);
+      }
+
       // MAуG[Ŕ
       obj->invalid_packet_ = false;
       CaptureType type =
         obj->scip_.receiveCaptureData(data.length_data, data.settings,
                                       &data.timestamp,
-                                      &remain_times, &total_times);
+                                      &remain_times, &total_times,
+                                      streaming ? obj->resyncTimeout() : 0);
+      {
+        LockGuard guard(obj->mutex_);
+        obj->countReceived(data.settings);
+      }
+      if ((type == QT) && (! obj->stop_requested_) &&
+          obj->applyReconfiguration()) {
+        // The stream was stopped by reconfigureCapture().
+        // Issue the capture command with the new settings immediately.
+        obj->sendCaptureCommand();
+        streaming = false;
+        continue;
+      }
+
+      if (type == QT) {
+        // The stream was stopped by stop() or setLaserOutput()
+        break;
+      }
+
       if (type == Mx_Reply) {
         // MS/MD ̉pPbg̏ꍇÃf[^҂
         continue;
       }
 
       if (! ((type == MD) || (type == MS) || (type == ME))) {
-        // Mf[^łȂ΁AXbh𒆒f
-        obj->invalid_packet_ = true;
-        ++obj->retry_times_;
-        break;
+        RecoverAction action = obj->recover();
+        while (action == RecoverWait) {
+          if (obj->stop_requested_) {
+            return 0;
+          }
+          delay(ReconnectPollMsec);
+          action = obj->recover();
+        }
+
+        if (action == RecoverFailed) {
+          obj->invalid_packet_ = true;
+          break;
+
+        } else if (action == RecoverRestart) {
+          obj->sendCaptureCommand();
+          streaming = false;
+        }
+        continue;
       }
-      obj->retry_times_ = 0;
+      obj->recovered();
+      streaming = true;
 
       // ^CX^v 24 bit Ȃ߁AP邱Ƃւ̑Ώ
       if ((data.timestamp >= 0) && (data.timestamp < obj->pre_timestamp_)) {
@@ -555,6 +869,9 @@ struct UrgDevice::pImpl
       }
       obj->pre_timestamp_ = data.timestamp;
       data.timestamp += obj->base_timestamp_;
+      if (obj->measure_latency_) {
+        data.decoded_ticks = preciseTicks();
+      }
 
       LockGuard guard(obj->mutex_);
       deque<ScanData>& data_buffer = obj->data_buffer_;
@@ -566,6 +883,12 @@ struct UrgDevice::pImpl
       if (erase_size > 0) {
         data_buffer.erase(data_buffer.begin(),
                           data_buffer.begin() + erase_size);
+        obj->statistics_.dropped_scans += erase_size;
+      }
+      ++obj->statistics_.received_scans;
+
+      if (obj->measure_latency_) {
+        obj->recordReceived(data);
       }
 
       // ̃f[^ǉ
@@ -706,7 +1029,18 @@ struct UrgDevice::pImpl
 
   void stop(void)
   {
+    stop_requested_ = true;
+    {
+      // The QT echo back must end the capture thread
+      LockGuard guard(mutex_);
+      reconfigure_requested_ = false;
+      reconfigure_sent_ = false;
+    }
     if (! isConnected()) {
+      if (thread_.isRunning()) {
+        // The capture thread may be waiting for the reconnection
+        thread_.wait();
+      }
       return;
     }
 
@@ -730,6 +1064,134 @@ struct UrgDevice::pImpl
     data_buffer_.clear();
     intensity_data_.length_data.clear();
   }
+
+
+  void reconfigureCapture(int begin_index, int end_index,
+                          size_t skip_lines, size_t interval)
+  {
+    LockGuard guard(mutex_);
+
+    if ((capture_mode_ == ManualCapture) || (! thread_.isRunning()) ||
+        (! isConnected())) {
+      // The next capture command uses the new settings as it is
+      capture_begin_ = begin_index;
+      capture_end_ = end_index;
+      capture_skip_lines_ = skip_lines;
+      capture_frame_interval_ = interval;
+      reconfigure_requested_ = false;
+      reconfigure_sent_ = false;
+      return;
+    }
+
+    // The capture thread sends QT, receives its echo back and sends the
+    // next command. A request before that only updates the settings.
+    next_capture_begin_ = begin_index;
+    next_capture_end_ = end_index;
+    next_capture_skip_lines_ = skip_lines;
+    next_capture_frame_interval_ = interval;
+    reconfigure_requested_ = true;
+  }
+
+
+  // Returns true once for each reconfiguration, when QT is to be sent
+  bool takeReconfiguration(void)
+  {
+    LockGuard guard(mutex_);
+    if ((! reconfigure_requested_) || reconfigure_sent_) {
+      return false;
+    }
+    reconfigure_sent_ = true;
+    return true;
+  }
+
+
+  // Called with mutex_ locked
+  void recordReceived(ScanData& data)
+  {
+    const CaptureSettings& settings = data.settings;
+    data.enqueued_ticks = preciseTicks();
+    if (data.decoded_ticks < settings.complete_ticks) {
+      data.decoded_ticks = data.enqueued_ticks;
+    }
+
+    latency_.add(CaptureLatency::Receive,
+                 settings.complete_ticks - settings.first_byte_ticks);
+    latency_.add(CaptureLatency::Decode,
+                 data.decoded_ticks - settings.complete_ticks);
+    latency_.add(CaptureLatency::Enqueue,
+                 data.enqueued_ticks - data.decoded_ticks);
+    if (pre_complete_ticks_ > 0.0) {
+      latency_.add(CaptureLatency::FrameInterval,
+                   settings.complete_ticks - pre_complete_ticks_);
+    }
+    pre_complete_ticks_ = settings.complete_ticks;
+  }
+
+
+  // Called with mutex_ locked
+  void countReceived(const CaptureSettings& settings)
+  {
+    statistics_.received_bytes += settings.received_bytes;
+    statistics_.checksum_errors += settings.checksum_errors;
+  }
+
+
+  void countRecovery(size_t CaptureStatistics::* counter)
+  {
+    LockGuard guard(mutex_);
+    ++(statistics_.*counter);
+  }
+
+
+  // Called with mutex_ locked
+  void recordDequeued(const ScanData& data)
+  {
+    if (data.enqueued_ticks <= 0.0) {
+      // stored before the measurement was enabled
+      return;
+    }
+    double now = preciseTicks();
+    latency_.add(CaptureLatency::Dequeue, now - data.enqueued_ticks);
+    latency_.add(CaptureLatency::EndToEnd,
+                 now - data.settings.first_byte_ticks);
+  }
+
+
+  // Called for a QT echo back, true when it is the one of reconfigureCapture()
+  bool applyReconfiguration(void)
+  {
+    LockGuard guard(mutex_);
+    if (! reconfigure_sent_) {
+      // stopped by setLaserOutput() or the other QT
+      return false;
+    }
+    adoptNextCapture();
+    return true;
+  }
+
+
+  // A restart issues the capture command anyway, with the pending settings
+  void adoptReconfiguration(void)
+  {
+    LockGuard guard(mutex_);
+    adoptNextCapture();
+  }
+
+
+  // Called with mutex_ locked
+  void adoptNextCapture(void)
+  {
+    if (! reconfigure_requested_) {
+      return;
+    }
+
+    capture_begin_ = next_capture_begin_;
+    capture_end_ = next_capture_end_;
+    capture_skip_lines_ = next_capture_skip_lines_;
+    capture_frame_interval_ = next_capture_frame_interval_;
+    reconfigure_requested_ = false;
+    reconfigure_sent_ = false;
+  }
 };
 
 
@@ -808,10 +1270,66 @@ int UrgDevice::maxScanLines(void) const
 
 void UrgDevice::setRetryTimes(size_t times)
 {
+  LockGuard guard(pimpl->mutex_);
   pimpl->max_retry_times_ = times;
 }
 
 
+void UrgDevice::setStatusCallback(void (*fn)(CaptureStatus status,
+                                             void* args), void* args)
+{
+  pimpl->status_function_ = fn;
+  pimpl->status_args_ = args;
+}
+
+
+UrgDevice::CaptureStatus UrgDevice::captureStatus(void) const
+{
+  return pimpl->currentStatus();
+}
+
+
+void UrgDevice::setLatencyMeasurement(bool on)
+{
+  LockGuard guard(pimpl->mutex_);
+  if (on && (! pimpl->measure_latency_)) {
+    pimpl->pre_complete_ticks_ = 0.0;
+  }
+  pimpl->measure_latency_ = on;
+}
+
+
+CaptureStatistics UrgDevice::statistics(void) const
+{
+  LockGuard guard(pimpl->mutex_);
+  CaptureStatistics snapshot = pimpl->statistics_;
+  snapshot.end_ticks = preciseTicks();
+  return snapshot;
+}
+
+
+void UrgDevice::clearStatistics(void)
+{
+  LockGuard guard(pimpl->mutex_);
+  pimpl->statistics_.clear(preciseTicks());
+}
+
+
+CaptureLatency UrgDevice::latency(void) const
+{
+  LockGuard guard(pimpl->mutex_);
+  return pimpl->latency_;
+}
+
+
+void UrgDevice::clearLatency(void)
+{
+  LockGuard guard(pimpl->mutex_);
+  pimpl->latency_.clear();
+  pimpl->pre_complete_ticks_ = 0.0;
+}
+
+
 void UrgDevice::setCapturesSize(size_t size)
 {
   pimpl->capture_->setCapturesSize(size);
@@ -896,6 +1414,13 @@ void UrgDevice::setCaptureTimes(size_t times)
 
 
 
+void UrgDevice::reconfigureCapture(int begin_index, int end_index,
+                                   size_t skip_lines, size_t interval)
+{
+  pimpl->reconfigureCapture(begin_index, end_index, skip_lines, interval);
+}
+
+
 void UrgDevice::setCaptureSkipLines(size_t skip_lines)
 {
   // capture ~Bcapture ̍ĊJ͍sȂ
@@ -906,6 +1431,16 @@ void UrgDevice::setCaptureSkipLines(size_t skip_lines)
 }
 
 
+void UrgDevice::setCaptureDataByte(size_t data_byte)
+{
+  // capture ~Bcapture ̍ĊJ͍sȂ
+  stop();
+  pimpl->clear();
+
+  pimpl->capture_data_byte_ = data_byte;
+}
+
+
 int UrgDevice::capture(vector<long>& data, long* timestamp)
 {
   // !!! ڑȂ΁A߂
@@ -965,10 +1500,48 @@ int UrgDevice::rad2index(const double radian) const
 }
 
 
+void UrgDevice::setAngleOffset(double radian)
+{
+  pimpl->angle_offset_ = radian;
+  pimpl->updateAngleTable();
+}
+
+
+double UrgDevice::angleOffset(void) const
+{
+  return pimpl->angle_offset_;
+}
+
+
+const double* UrgDevice::angleTable(void) const
+{
+  return pimpl->angle_table_.empty() ? NULL : &pimpl->angle_table_[0];
+}
+
+
+const double* UrgDevice::cosTable(void) const
+{
+  return pimpl->cos_table_.empty() ? NULL : &pimpl->cos_table_[0];
+}
+
+
+const double* UrgDevice::sinTable(void) const
+{
+  return pimpl->sin_table_.empty() ? NULL : &pimpl->sin_table_[0];
+}
+
+
+size_t UrgDevice::angleTableSize(void) const
+{
+  return pimpl->angle_table_.size();
+}
+
+
 void UrgDevice::setParameter(const RangeSensorParameter& parameter)
 {
   pimpl->parameters_ = parameter;
   pimpl->updateCaptureParameters();
+  pimpl->updateAngleTable();
 }
 
 
@@ -12,6 +12,8 @@
 
 #include "RangeSensor.h"
 #include "Coordinate.h"
+#include "CaptureLatency.h"
+#include "CaptureStatistics.h"
 
 
 namespace qrk
@@ -34,6 +36,16 @@ namespace qrk
             On = 1,                   //!< Laser is on
         };
 
+
+        //! Status of data acquisition
+        typedef enum {
+            Capturing,                //!< Scan data is received normally
+            Resyncing,                //!< Waiting for the next echo back
+            Restarting,               //!< Capture command is issued again
+            Reconnecting,             //!< Connection is opened again
+            CaptureFailed,            //!< Recovery was given up
+        } CaptureStatus;
+
         UrgDevice(void);
         virtual ~UrgDevice(void);
 
@@ -54,14 +66,89 @@ namespace qrk
           \brief Set number of retry times when connection failed
 
           The retry counter is cleared when connect normaly.
+          Specify #Infinity to keep reconnecting until it succeeds.
 
           \param[in] times retry times
-
-          \attention Data acquisition mode is valid only at #AutoCapture
         */
         void setRetryTimes(size_t times);
 
 
+        /*!
+          \brief Register the function called when the capture status changes
+
+          When a broken packet or a timeout is detected, the capture is
+          recovered in the following order. Each transition is reported
+          to the registered function.
+
+          -# #Resyncing: the stream is kept, and the next echo back is waited
+          -# #Restarting: QT is sent and the capture command is issued again
+          -# #Reconnecting: the connection is opened again with backoff
+
+          \param[in] fn function called with the new status
+          \param[in] args argument passed to fn
+
+          \attention In #AutoCapture and #IntensityCapture, fn is called from
+          the capture thread.
+        */
+        void setStatusCallback(void (*fn)(CaptureStatus status, void* args),
+                               void* args);
+
+
+        /*!
+          \brief Status of data acquisition
+
+          \return Present status of data acquisition
+        */
+        CaptureStatus captureStatus(void) const;
+
+
+        /*!
+          \brief Counters of the capture stream
+
+          Received and dropped scans, checksum errors, recoveries and
+          received bytes are counted while the device is used.
+
+          \return snapshot of the counters
+
+          \see CaptureStatistics::diff()
+        */
+        CaptureStatistics statistics(void) const;
+
+
+        /*!
+          \brief Reset the counters of the capture stream
+        */
+        void clearStatistics(void);
+
+
+        /*!
+          \brief Record the latency of each capture stage
+
+          When enabled, the time from the arrival of the echo back to the
+          frame complete, the decode, the storing to the buffer and the
+          dequeue by capture() are recorded for each scan.
+
+          \param[in] on true to record, false to stop recording
+
+          \see latency()
+        */
+        void setLatencyMeasurement(bool on);
+
+
+        /*!
+          \brief Recorded latency statistics
+
+          \return copy of the statistics recorded until now
+        */
+        CaptureLatency latency(void) const;
+
+
+        /*!
+          \brief Clear the recorded latency statistics
+        */
+        void clearLatency(void);
+
+
         /*!
           \brief Set number of scan data stored internally
 
@@ -169,6 +256,39 @@ namespace qrk
         void setCaptureSkipLines(size_t skip_lines);
 
 
+        /*!
+          \brief Set number of characters to encode a distance
+
+          With 2, GS/MS is used instead of GD/MD. The traffic is reduced to
+          2/3, while the distance is limited to 4095 [mm]. The setting is
+          ignored in #IntensityCapture.
+
+          \param[in] data_byte 2 or 3 (default)
+        */
+        void setCaptureDataByte(size_t data_byte);
+
+
+        /*!
+          \brief Change the capture settings at the next scan boundary
+
+          Unlike setCaptureRange(), setCaptureFrameInterval() and
+          setCaptureSkipLines(), the capture thread is not stopped and the
+          stored scan data is not cleared. While MD/MS/ME is streaming, the
+          capture thread sends QT after the scan being received, and issues
+          the capture command with the new settings as soon as the QT echo
+          back arrives. stop() cancels a pending reconfiguration.
+
+          \param[in] begin_index Measurement beginning position
+          \param[in] end_index Measurement end position
+          \param[in] skip_lines number of scanline to be skipped
+          \param[in] interval capture interval
+
+          \see setCaptureRange(), setCaptureSkipLines(), setCaptureFrameInterval()
+        */
+        void reconfigureCapture(int begin_index, int end_index,
+                                size_t skip_lines, size_t interval);
+
+
         int capture(std::vector<long>& data, long* timestamp = NULL);
 
 
@@ -206,6 +326,36 @@ namespace qrk
         double index2rad(const int index) const;
         int rad2index(const double radian) const;
 
+
+        /*!
+          \brief Set the angle added to cosTable() and sinTable()
+
+          \param[in] radian offset angle [radian]
+        */
+        void setAngleOffset(double radian);
+        double angleOffset(void) const;
+
+
+        /*!
+          \brief Angle of each index
+
+          The tables are built when the parameter is loaded or the angle
+          offset is changed, and the pointers are valid until then.
+          Index i of the tables corresponds to index i of the data returned
+          by capture(), for any capture range and skip lines.
+
+          \return angleTableSize() angles, same as index2rad() [radian]
+        */
+        const double* angleTable(void) const;
+
+        //! cos(angleTable()[i] + angleOffset())
+        const double* cosTable(void) const;
+
+        //! sin(angleTable()[i] + angleOffset())
+        const double* sinTable(void) const;
+
+        size_t angleTableSize(void) const;
+
         void setParameter(const RangeSensorParameter& parameter);
         RangeSensorParameter parameter(void) const;
 
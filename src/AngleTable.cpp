@@ -0,0 +1,64 @@
+//
+//  AngleTable.cpp
+//  example_ofxUrgDevice
+//
+//
+
+#include "AngleTable.h"
+
+using namespace ofxUrg;
+
+AngleTable::AngleTable(vector<float> const& _angles, float _sensor_angle)
+{
+    setAngles(_angles, _sensor_angle);
+}
+
+void AngleTable::setTables(double const* _angles, double const* _cos, double const* _sin,
+                           int size, float _sensor_angle)
+{
+    sensor_angle = _sensor_angle;
+    angles.assign(_angles, _angles + size);
+    cosines.assign(_cos, _cos + size);
+    sines.assign(_sin, _sin + size);
+}
+
+void AngleTable::setAngles(vector<float> const& _angles, float _sensor_angle)
+{
+    sensor_angle = _sensor_angle;
+    angles = _angles;
+    updateTrig(0);
+}
+
+void AngleTable::setSensorAngle(float _sensor_angle)
+{
+    if (sensor_angle == _sensor_angle) {
+        return;
+    }
+    sensor_angle = _sensor_angle;
+    updateTrig(0);
+}
+
+void AngleTable::resize(int size)
+{
+    int from = angles.size();
+    angles.resize(size);
+    updateTrig(min(from, size));
+}
+
+void AngleTable::addAngle(float angle)
+{
+    angles.push_back(angle);
+    updateTrig(angles.size() - 1);
+}
+
+void AngleTable::updateTrig(int from)
+{
+    cosines.resize(angles.size());
+    sines.resize(angles.size());
+    
+    float offset = ofDegToRad(sensor_angle + 90);
+    for (int i=from; i<angles.size(); i++) {
+        cosines[i] = cos(angles[i] + offset);
+        sines[i] = sin(angles[i] + offset);
+    }
+}
@@ -0,0 +1,50 @@
+//
+//  AngleTable.h
+//  example_ofxUrgDevice
+//
+//
+
+#ifndef __example_ofxUrgDevice__AngleTable__
+#define __example_ofxUrgDevice__AngleTable__
+
+#include "ofMain.h"
+
+namespace ofxUrg {
+
+    // angle of each beam and its cos/sin rotated by (sensor_angle + 90) degree,
+    // the screen direction used by UrgData::draw().
+    // built once per parameter set and shared between frames through ofPtr.
+    class AngleTable
+    {
+    public:
+        AngleTable() : sensor_angle(0) {}
+        AngleTable(vector<float> const& _angles, float _sensor_angle);
+        
+        // copies the tables built by qrk::UrgDevice
+        void setTables(double const* _angles, double const* _cos, double const* _sin,
+                       int size, float _sensor_angle);
+        void setAngles(vector<float> const& _angles, float _sensor_angle);
+        void setSensorAngle(float _sensor_angle);
+        void resize(int size);
+        void addAngle(float angle);
+        
+        int size() const { return angles.size(); }
+        float getSensorAngle() const { return sensor_angle; }
+        vector<float> const& getAnglesRef() const { return angles; }
+        vector<float> const& getCosRef() const { return cosines; }
+        vector<float> const& getSinRef() const { return sines; }
+        
+    private:
+        void updateTrig(int from);
+        
+        vector<float> angles;
+        vector<float> cosines;
+        vector<float> sines;
+        float sensor_angle;
+    };
+    
+    typedef ofPtr<AngleTable> AngleTablePtr;
+
+}
+
+#endif /* defined(__example_ofxUrgDevice__AngleTable__) */
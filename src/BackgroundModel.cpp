@@ -0,0 +1,176 @@
+//
+//  BackgroundModel.cpp
+//  example_ofxUrgDevice
+//
+//
+
+#include "BackgroundModel.h"
+#include <fstream>
+
+using namespace ofxUrg;
+
+namespace {
+    const char Magic[] = "URGBG1";
+    // bytes of a beam in the file: mean, variance and samples
+    const int BeamBytes = 2 * sizeof(float) + sizeof(unsigned short);
+}
+
+BackgroundModel::BackgroundModel()
+:learned_frames(0), frozen(false)
+{
+    setup();
+}
+
+void BackgroundModel::setup(int learn_frames_, float adapt_rate_, float sigma_, float min_margin_)
+{
+    learn_frames = learn_frames_;
+    adapt_rate = adapt_rate_;
+    sigma = sigma_;
+    min_margin = min_margin_;
+}
+
+void BackgroundModel::relearn()
+{
+    learned_frames = 0;
+    mean.assign(mean.size(), FLT_MAX);
+    variance.assign(variance.size(), 0);
+    samples.assign(samples.size(), 0);
+}
+
+void BackgroundModel::resize(int size)
+{
+    mean.resize(size);
+    variance.resize(size);
+    samples.resize(size);
+    relearn();
+}
+
+void BackgroundModel::update(UrgData const& data)
+{
+    vector<long> const& d = data.getDataRef();
+    int n = d.size();
+    if (n != mean.size()) {
+        // the capture range was changed
+        resize(n);
+    }
+    
+    foreground.resize(n);
+    foreground_indices.clear();
+    vector<int> const& survivors = data.getValidIndicesRef();
+    
+    // detection, one mask word at a time
+    if (isLearned()) {
+        vector<BeamMask::Word>& words = foreground.getWordsRef();
+        float const* m = n ? &mean[0] : NULL;
+        float const* v = n ? &variance[0] : NULL;
+        long const* r = n ? &d[0] : NULL;
+        float k2 = sigma * sigma;
+        float margin2 = min_margin * min_margin;
+        for (int w=0; w<words.size(); w++) {
+            int first = w * BeamMask::WordBits;
+            int last = min(first + (int)BeamMask::WordBits, n);
+            BeamMask::Word bits = 0;
+            for (int i=first; i<last; i++) {
+                float diff = m[i] - r[i];
+                bool closer = (diff > 0) & (diff * diff > max(k2 * v[i], margin2));
+                bits |= BeamMask::Word(closer) << (i - first);
+            }
+            words[w] = bits;
+        }
+        // invalid beams are not foreground
+        if (data.getValidMaskRef().size() == n) {
+            foreground &= data.getValidMaskRef();
+        }
+        for (int i=foreground.next(0); i>=0; i=foreground.next(i+1)) {
+            foreground_indices.push_back(i);
+        }
+    }
+    
+    if (frozen) {
+        return;
+    }
+    
+    // learning: valid background beams only
+    for (int k=0; k<survivors.size(); k++) {
+        int i = survivors[k];
+        if (foreground.test(i)) continue;
+        
+        float rate;
+        if (samples[i] == 0) {
+            rate = 1;
+            mean[i] = d[i];
+        } else if (!isLearned()) {
+            // running average while learning
+            rate = 1.0 / (samples[i] + 1);
+        } else {
+            rate = adapt_rate;
+        }
+        float delta = d[i] - mean[i];
+        mean[i] += rate * delta;
+        variance[i] = (1 - rate) * (variance[i] + rate * delta * delta);
+        if (samples[i] < USHRT_MAX) samples[i]++;
+    }
+    if (learned_frames < learn_frames) {
+        learned_frames++;
+    }
+}
+
+bool BackgroundModel::save(string const& path) const
+{
+    ofstream out(ofToDataPath(path).c_str(), ios::binary);
+    if (!out) {
+        return false;
+    }
+    int n = mean.size();
+    out.write(Magic, sizeof(Magic));
+    out.write((char const*) &n, sizeof(n));
+    out.write((char const*) &learned_frames, sizeof(learned_frames));
+    if (n) {
+        out.write((char const*) &mean[0], n * sizeof(float));
+        out.write((char const*) &variance[0], n * sizeof(float));
+        out.write((char const*) &samples[0], n * sizeof(unsigned short));
+    }
+    return out.good();
+}
+
+bool BackgroundModel::load(string const& path)
+{
+    ifstream in(ofToDataPath(path).c_str(), ios::binary);
+    char magic[sizeof(Magic)];
+    int n = 0;
+    int frames = 0;
+    if (!in.read(magic, sizeof(magic)) || memcmp(magic, Magic, sizeof(Magic))) {
+        ofLogError("BackgroundModel") << "load: " << path << " is not a background model";
+        return false;
+    }
+    in.read((char*) &n, sizeof(n));
+    in.read((char*) &frames, sizeof(frames));
+    if (!in) {
+        return false;
+    }
+    // the beam count must match the rest of the file before anything is allocated
+    streampos body = in.tellg();
+    in.seekg(0, ios::end);
+    streamoff remain = in.tellg() - body;
+    in.seekg(body);
+    if (n < 0 || frames < 0 || remain != (streamoff) n * BeamBytes) {
+        ofLogError("BackgroundModel") << "load: " << path << " is broken";
+        return false;
+    }
+    
+    vector<float> m(n), v(n);
+    vector<unsigned short> s(n);
+    if (n) {
+        in.read((char*) &m[0], n * sizeof(float));
+        in.read((char*) &v[0], n * sizeof(float));
+        in.read((char*) &s[0], n * sizeof(unsigned short));
+    }
+    if (!in) {
+        return false;
+    }
+    mean.swap(m);
+    variance.swap(v);
+    samples.swap(s);
+    learned_frames = frames;
+    return true;
+}
@@ -0,0 +1,68 @@
+//
+//  BackgroundModel.h
+//  example_ofxUrgDevice
+//
+//
+
+#ifndef __example_ofxUrgDevice__BackgroundModel__
+#define __example_ofxUrgDevice__BackgroundModel__
+
+#include "ofMain.h"
+#include "UrgData.h"
+#include "BeamMask.h"
+
+namespace ofxUrg {
+
+    // per-beam running mean and variance of the background range.
+    // beams nearer than the background by more than the threshold are
+    // foreground. the first learn_frames scans only train the model.
+    class BackgroundModel
+    {
+    public:
+        BackgroundModel();
+        
+        // learn_frames: scans averaged before detection starts
+        // adapt_rate: weight of a new background sample afterwards
+        // sigma: threshold in standard deviations, min_margin: lower bound of the threshold [mm]
+        void setup(int learn_frames = 30, float adapt_rate = 0.01, float sigma = 3, float min_margin = 50);
+        
+        void update(UrgData const& data);
+        
+        // foreground beams of the last update()
+        BeamMask const& getForegroundRef() const { return foreground; }
+        vector<int> const& getForegroundIndicesRef() const { return foreground_indices; }
+        
+        bool isLearned() const { return learned_frames >= learn_frames; }
+        // stops adapting the model to the scene
+        void setFrozen(bool frozen_) { frozen = frozen_; }
+        bool isFrozen() const { return frozen; }
+        // forgets the model and learns again from the next scan
+        void relearn();
+        
+        bool save(string const& path) const;
+        bool load(string const& path);
+        
+        vector<float> const& getMeanRef() const { return mean; }
+        vector<float> const& getVarianceRef() const { return variance; }
+        
+    private:
+        void resize(int size);
+        
+        int learn_frames;
+        float adapt_rate;
+        float sigma;
+        float min_margin;
+        
+        int learned_frames;
+        bool frozen;
+        vector<float> mean;         // FLT_MAX: no echo has been seen
+        vector<float> variance;
+        vector<unsigned short> samples;
+        
+        BeamMask foreground;
+        vector<int> foreground_indices;
+    };
+
+}
+
+#endif /* defined(__example_ofxUrgDevice__BackgroundModel__) */
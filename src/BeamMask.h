@@ -0,0 +1,125 @@
+//
+//  BeamMask.h
+//  example_ofxUrgDevice
+//
+//
+
+#ifndef __example_ofxUrgDevice__BeamMask__
+#define __example_ofxUrgDevice__BeamMask__
+
+#include <vector>
+#include <algorithm>
+
+namespace ofxUrg {
+
+    // one bit per beam, packed into 32 bit words
+    class BeamMask
+    {
+    public:
+        typedef unsigned int Word;
+        enum { WordBits = 32 };
+
+        BeamMask() : num_bits(0) {}
+        explicit BeamMask(int size, bool value = false) : num_bits(0) { resize(size, value); }
+
+        int size() const { return num_bits; }
+        bool empty() const { return num_bits == 0; }
+        int numWords() const { return words.size(); }
+
+        void resize(int size, bool value = false)
+        {
+            num_bits = size;
+            words.assign((size + WordBits - 1) / WordBits, value ? ~Word(0) : Word(0));
+            clearTail();
+        }
+
+        void clear() { words.clear(); num_bits = 0; }
+        void setAll(bool value)
+        {
+            std::fill(words.begin(), words.end(), value ? ~Word(0) : Word(0));
+            clearTail();
+        }
+
+        void set(int i) { words[i / WordBits] |= Word(1) << (i % WordBits); }
+        void reset(int i) { words[i / WordBits] &= ~(Word(1) << (i % WordBits)); }
+        void set(int i, bool value) { value ? set(i) : reset(i); }
+        bool test(int i) const { return (words[i / WordBits] >> (i % WordBits)) & 1; }
+        bool operator[](int i) const { return test(i); }
+
+        int count() const
+        {
+            int n = 0;
+            for (int i=0; i<words.size(); i++) {
+                Word w = words[i];
+                while (w) {
+                    w &= w - 1;
+                    n++;
+                }
+            }
+            return n;
+        }
+
+        // index of the first set bit at or after "from", or -1
+        int next(int from) const
+        {
+            if (from >= num_bits) return -1;
+            int wi = from / WordBits;
+            Word w = words[wi] & (~Word(0) << (from % WordBits));
+            while (!w) {
+                if (++wi >= words.size()) return -1;
+                w = words[wi];
+            }
+            int bit = 0;
+            while (!((w >> bit) & 1)) bit++;
+            return wi * WordBits + bit;
+        }
+
+        BeamMask& operator&=(BeamMask const& rhs)
+        {
+            int n = std::min(words.size(), rhs.words.size());
+            for (int i=0; i<n; i++) words[i] &= rhs.words[i];
+            std::fill(words.begin() + n, words.end(), Word(0));
+            return *this;
+        }
+
+        BeamMask& operator|=(BeamMask const& rhs)
+        {
+            int n = std::min(words.size(), rhs.words.size());
+            for (int i=0; i<n; i++) words[i] |= rhs.words[i];
+            clearTail();
+            return *this;
+        }
+
+        // clears the bits set in rhs
+        BeamMask& subtract(BeamMask const& rhs)
+        {
+            int n = std::min(words.size(), rhs.words.size());
+            for (int i=0; i<n; i++) words[i] &= ~rhs.words[i];
+            return *this;
+        }
+
+        void invert()
+        {
+            for (int i=0; i<words.size(); i++) words[i] = ~words[i];
+            clearTail();
+        }
+
+        std::vector<Word>& getWordsRef() { return words; }
+        std::vector<Word> const& getWordsRef() const { return words; }
+
+    private:
+        void clearTail()
+        {
+            int rest = num_bits % WordBits;
+            if (rest && !words.empty()) {
+                words.back() &= (Word(1) << rest) - 1;
+            }
+        }
+
+        std::vector<Word> words;
+        int num_bits;
+    };
+
+}
+
+#endif /* defined(__example_ofxUrgDevice__BeamMask__) */
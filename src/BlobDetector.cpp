@@ -0,0 +1,209 @@
+//
+//  BlobDetector.cpp
+//  example_ofxUrgDevice
+//
+//
+
+#include "BlobDetector.h"
+
+using namespace ofxUrg;
+
+BlobDetector::BlobDetector()
+:width(0), height(0)
+{
+    setup(ofRectangle(-5000, -5000, 10000, 10000));
+}
+
+void BlobDetector::setup(ofRectangle const& area_, float resolution_, int radius_, int min_area_)
+{
+    area = area_;
+    resolution = max(resolution_, 1.0f);
+    radius = max(radius_, 0);
+    min_area = max(min_area_, 1);
+    width = max((int)ceil(area.width / resolution), 1);
+    height = max((int)ceil(area.height / resolution), 1);
+
+    bitmap.assign(width * height, 0);
+    counts.assign(width * height, 0);
+    labels.assign(width * height, -1);
+    blobs.clear();
+}
+
+void BlobDetector::clear()
+{
+    fill(bitmap.begin(), bitmap.end(), 0);
+    fill(counts.begin(), counts.end(), 0);
+}
+
+void BlobDetector::splat(float x, float y)
+{
+    int u = floor((x - area.x) / resolution);
+    int v = floor((y - area.y) / resolution);
+    if (u < 0 || u >= width || v < 0 || v >= height) {
+        return;
+    }
+    counts[v * width + u]++;
+    int u0 = max(u - radius, 0), u1 = min(u + radius, width - 1);
+    int v0 = max(v - radius, 0), v1 = min(v + radius, height - 1);
+    for (int y=v0; y<=v1; y++) {
+        unsigned char* row = &bitmap[y * width];
+        for (int x=u0; x<=u1; x++) {
+            row[x] = 255;
+        }
+    }
+}
+
+void BlobDetector::update(vector<ofVec2f> const& points)
+{
+    clear();
+    for (int i=0; i<points.size(); i++) {
+        splat(points[i].x, points[i].y);
+    }
+    label();
+}
+
+void BlobDetector::update(UrgData const& data, SensorPose const& pose)
+{
+    // the rotation of the pose is already applied by setSensorAngle()
+    clear();
+    vector<int> const& survivors = data.getValidIndicesRef();
+    vector<float> const& xs = data.getXsRef();
+    vector<float> const& ys = data.getYsRef();
+    for (int k=0; k<survivors.size(); k++) {
+        splat(xs[survivors[k]] + pose.x, ys[survivors[k]] + pose.y);
+    }
+    label();
+}
+
+int BlobDetector::find(int a)
+{
+    while (parents[a] != a) {
+        // path halving
+        parents[a] = parents[parents[a]];
+        a = parents[a];
+    }
+    return a;
+}
+
+int BlobDetector::join(int a, int b)
+{
+    a = find(a);
+    b = find(b);
+    if (a < b) {
+        parents[b] = a;
+        return a;
+    }
+    parents[a] = b;
+    return b;
+}
+
+void BlobDetector::label()
+{
+    // first pass: provisional labels from the west, north-west, north and
+    // north-east neighbours. the neighbours that touch each other already
+    // share a label, so at most one join is needed per pixel.
+    parents.clear();
+    for (int v=0; v<height; v++) {
+        unsigned char const* row = &bitmap[v * width];
+        int* current = &labels[v * width];
+        int const* above = v > 0 ? &labels[(v - 1) * width] : NULL;
+        for (int u=0; u<width; u++) {
+            if (!row[u]) {
+                current[u] = -1;
+                continue;
+            }
+            int n = above ? above[u] : -1;
+            int l = n;
+            if (n < 0) {
+                int w = u > 0 ? current[u - 1] : -1;
+                int nw = above && u > 0 ? above[u - 1] : -1;
+                int ne = above && u + 1 < width ? above[u + 1] : -1;
+                int left = w >= 0 ? w : nw;
+                if (left >= 0 && ne >= 0) {
+                    l = join(left, ne);
+                } else {
+                    l = left >= 0 ? left : ne;
+                }
+            }
+            if (l < 0) {
+                l = parents.size();
+                parents.push_back(l);
+            }
+            current[u] = l;
+        }
+    }
+
+    // joins always point to the smaller label, so one pass in label order
+    // resolves every label to its root, numbered in raster order
+    blob_of_label.resize(parents.size());
+    accumulators.clear();
+    for (int i=0; i<parents.size(); i++) {
+        if (parents[i] == i) {
+            blob_of_label[i] = accumulators.size();
+            Accumulator a = { 0, 0, 0, 0, INT_MAX, INT_MAX, INT_MIN, INT_MIN };
+            accumulators.push_back(a);
+        } else {
+            parents[i] = parents[parents[i]];
+            blob_of_label[i] = blob_of_label[parents[i]];
+        }
+    }
+
+    // second pass: statistics of each blob
+    for (int v=0; v<height; v++) {
+        int* current = &labels[v * width];
+        int const* points = &counts[v * width];
+        for (int u=0; u<width; u++) {
+            if (current[u] < 0) continue;
+            int b = blob_of_label[current[u]];
+            Accumulator& a = accumulators[b];
+            a.area++;
+            a.points += points[u];
+            a.sum_u += u;
+            a.sum_v += v;
+            a.u0 = min(a.u0, u);
+            a.u1 = max(a.u1, u);
+            a.v0 = min(a.v0, v);
+            a.v1 = v;
+            current[u] = b;
+        }
+    }
+
+    // drops small blobs, and converts to world coordinates
+    blobs.clear();
+    renumber.resize(accumulators.size());
+    bool dropped = false;
+    for (int b=0; b<accumulators.size(); b++) {
+        Accumulator const& a = accumulators[b];
+        if (a.area < min_area) {
+            renumber[b] = -1;
+            dropped = true;
+            continue;
+        }
+        renumber[b] = blobs.size();
+        Blob blob;
+        blob.area = a.area;
+        blob.points = a.points;
+        blob.centroid = ofVec2f(area.x + (a.sum_u / a.area + 0.5) * resolution,
+                                area.y + (a.sum_v / a.area + 0.5) * resolution);
+        blob.bounds = ofRectangle(area.x + a.u0 * resolution, area.y + a.v0 * resolution,
+                                  (a.u1 - a.u0 + 1) * resolution, (a.v1 - a.v0 + 1) * resolution);
+        blobs.push_back(blob);
+    }
+    if (dropped) {
+        for (int i=0; i<labels.size(); i++) {
+            if (labels[i] >= 0) labels[i] = renumber[labels[i]];
+        }
+    }
+}
+
+void BlobDetector::draw() const
+{
+    ofPushStyle();
+    ofNoFill();
+    for (int i=0; i<blobs.size(); i++) {
+        ofSetColor(ofColor::fromHsb((i*40) % 256, 255, 255));
+        ofRect(blobs[i].bounds);
+        ofCircle(blobs[i].centroid.x, blobs[i].centroid.y, 50);
+    }
+    ofPopStyle();
+}
@@ -0,0 +1,90 @@
+//
+//  BlobDetector.h
+//  example_ofxUrgDevice
+//
+//
+
+#ifndef __example_ofxUrgDevice__BlobDetector__
+#define __example_ofxUrgDevice__BlobDetector__
+
+#include "ofMain.h"
+#include "UrgData.h"
+#include "SensorPose.h"
+#include <climits>
+
+namespace ofxUrg {
+
+    // a group of connected pixels, in world coordinates [mm]
+    struct Blob
+    {
+        int area;           // [pixel]
+        int points;         // scan points splatted into the blob
+        ofVec2f centroid;
+        ofRectangle bounds;
+    };
+
+    // draws scan points into a top-down bitmap on the CPU, and groups the
+    // set pixels by two-pass connected component labeling (8-connected,
+    // union-find), without OpenCV or a GL readback. the bitmap and the work
+    // arrays are kept between frames.
+    class BlobDetector
+    {
+    public:
+        BlobDetector();
+
+        // area: the part of the floor in the bitmap [mm], resolution: pixel size [mm].
+        // radius: each point also sets the pixels around it [pixel], so that the
+        // sparse points of far objects still touch. min_area: smaller blobs are dropped [pixel].
+        void setup(ofRectangle const& area, float resolution = 20, int radius = 1, int min_area = 4);
+
+        // e.g. ofxUrgManager::getPointsRef() for every sensor
+        void update(vector<ofVec2f> const& points);
+        // the valid beams, placed the same way as ofxUrgManager
+        void update(UrgData const& data, SensorPose const& pose = SensorPose());
+
+        vector<Blob> const& getBlobsRef() const { return blobs; }
+
+        // one byte per pixel, 255 where a point was splatted, row-major
+        vector<unsigned char> const& getBitmapRef() const { return bitmap; }
+        // the blob index of each pixel, -1 for the background or dropped blobs
+        vector<int> const& getLabelsRef() const { return labels; }
+        int getWidth() const { return width; }
+        int getHeight() const { return height; }
+
+        void draw() const;
+
+    private:
+        struct Accumulator
+        {
+            int area;
+            int points;
+            double sum_u, sum_v;
+            int u0, v0, u1, v1;
+        };
+
+        void clear();
+        void splat(float x, float y);
+        void label();
+        int find(int a);
+        int join(int a, int b);
+
+        ofRectangle area;
+        float resolution;
+        int radius;
+        int min_area;
+        int width;
+        int height;
+
+        vector<unsigned char> bitmap;
+        vector<int> counts;         // points of each pixel
+        vector<int> labels;
+        vector<int> parents;        // union-find over the provisional labels
+        vector<int> blob_of_label;
+        vector<Accumulator> accumulators;
+        vector<int> renumber;
+        vector<Blob> blobs;
+    };
+
+}
+
+#endif /* defined(__example_ofxUrgDevice__BlobDetector__) */
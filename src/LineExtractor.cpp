@@ -0,0 +1,269 @@
+//
+//  LineExtractor.cpp
+//  example_ofxUrgDevice
+//
+//
+
+#include "LineExtractor.h"
+
+using namespace ofxUrg;
+
+LineExtractor::LineExtractor()
+{
+    setup();
+    setCornerCondition();
+    segments.reserve(64);
+    corners.reserve(64);
+}
+
+void LineExtractor::setup(float split_distance_, float break_distance_,
+                          int min_points_, float min_length_, float sigma_)
+{
+    split_distance = split_distance_;
+    break_distance = break_distance_;
+    min_points = max(min_points_, 2);
+    min_length = min_length_;
+    sigma = sigma_;
+}
+
+void LineExtractor::setCornerCondition(float distance, float min_angle)
+{
+    corner_distance = distance;
+    corner_angle = min_angle;
+}
+
+void LineExtractor::update(UrgData const& data)
+{
+    segments.clear();
+    corners.clear();
+    spans.clear();
+
+    vector<int> const& indices = data.getValidIndicesRef();
+    vector<float> const& xs = data.getXsRef();
+    vector<float> const& ys = data.getYsRef();
+    int m = indices.size();
+    if (m < 2) {
+        return;
+    }
+    buildSums(xs, ys, indices);
+
+    // runs of neighbouring points
+    float break2 = break_distance * break_distance;
+    Span run = { 0, 0, 0 };
+    for (int k=1; k<=m; k++) {
+        bool end = k == m;
+        if (!end) {
+            float dx = xs[indices[k]] - xs[indices[k - 1]];
+            float dy = ys[indices[k]] - ys[indices[k - 1]];
+            end = dx * dx + dy * dy > break2;
+        }
+        if (end) {
+            run.b = k - 1;
+            split(xs, ys, indices, run);
+            run.a = k;
+            run.run++;
+        }
+    }
+
+    merge();
+    finish(xs, ys, indices);
+    findCorners();
+}
+
+void LineExtractor::buildSums(vector<float> const& xs, vector<float> const& ys, vector<int> const& indices)
+{
+    int m = indices.size();
+    sx.resize(m + 1);
+    sy.resize(m + 1);
+    sxx.resize(m + 1);
+    sxy.resize(m + 1);
+    syy.resize(m + 1);
+    sx[0] = sy[0] = sxx[0] = sxy[0] = syy[0] = 0;
+    for (int k=0; k<m; k++) {
+        double x = xs[indices[k]];
+        double y = ys[indices[k]];
+        sx[k + 1] = sx[k] + x;
+        sy[k + 1] = sy[k] + y;
+        sxx[k + 1] = sxx[k] + x * x;
+        sxy[k + 1] = sxy[k] + x * y;
+        syy[k + 1] = syy[k] + y * y;
+    }
+}
+
+// splits at the point farthest from the chord, leaves in scan order
+void LineExtractor::split(vector<float> const& xs, vector<float> const& ys, vector<int> const& indices, Span run)
+{
+    stack.clear();
+    stack.push_back(run);
+    while (!stack.empty()) {
+        Span s = stack.back();
+        stack.pop_back();
+
+        int farthest = -1;
+        if (s.b - s.a >= 2) {
+            ofVec2f p(xs[indices[s.a]], ys[indices[s.a]]);
+            ofVec2f q(xs[indices[s.b]], ys[indices[s.b]]);
+            ofVec2f d = q - p;
+            float length = d.length();
+            // distance to the chord, scaled by its length
+            float largest = split_distance * length;
+            for (int k=s.a + 1; k<s.b; k++) {
+                ofVec2f v(xs[indices[k]] - p.x, ys[indices[k]] - p.y);
+                float distance = fabs(d.x * v.y - d.y * v.x);
+                if (distance > largest) {
+                    largest = distance;
+                    farthest = k;
+                }
+            }
+        }
+
+        if (farthest < 0) {
+            spans.push_back(s);
+        } else {
+            Span left = { s.a, farthest, s.run };
+            Span right = { farthest + 1, s.b, s.run };
+            stack.push_back(right);
+            stack.push_back(left);
+        }
+    }
+}
+
+// joins neighbouring spans of the same run while they fit one line
+void LineExtractor::merge()
+{
+    if (spans.empty()) {
+        return;
+    }
+    int n = 0;
+    for (int i=1; i<spans.size(); i++) {
+        Span& last = spans[n];
+        Span next = spans[i];
+        if (next.run == last.run) {
+            Span joined = { last.a, next.b, last.run };
+            if (fit(joined).rms <= split_distance * 0.5) {
+                last = joined;
+                continue;
+            }
+        }
+        spans[++n] = next;
+    }
+    spans.resize(n + 1);
+}
+
+LineSegment LineExtractor::fit(Span span) const
+{
+    LineSegment line;
+    int n = span.b - span.a + 1;
+    double mx = (sx[span.b + 1] - sx[span.a]) / n;
+    double my = (sy[span.b + 1] - sy[span.a]) / n;
+    // scatter around the centroid
+    double cxx = (sxx[span.b + 1] - sxx[span.a]) - n * mx * mx;
+    double cxy = (sxy[span.b + 1] - sxy[span.a]) - n * mx * my;
+    double cyy = (syy[span.b + 1] - syy[span.a]) - n * my * my;
+
+    double alpha = 0.5 * atan2(-2 * cxy, cyy - cxx);
+    double r = mx * cos(alpha) + my * sin(alpha);
+    if (r < 0) {
+        r = -r;
+        alpha += alpha < 0 ? PI : -PI;
+    }
+    double spread = sqrt((cxx - cyy) * (cxx - cyy) + 4 * cxy * cxy);
+    double across = max(0.5 * (cxx + cyy - spread), 0.0);     // residual
+    double along = max(0.5 * (cxx + cyy + spread), 1e-6);
+
+    line.alpha = alpha;
+    line.r = r;
+    line.count = n;
+    line.rms = sqrt(across / n);
+
+    // first order propagation of the point noise. the offset of the
+    // centroid along the line couples alpha and r.
+    double noise = sigma * sigma;
+    if (n > 2) {
+        noise = max(noise, across / (n - 2));
+    }
+    double t0 = -mx * sin(alpha) + my * cos(alpha);
+    line.var_alpha = noise / along;
+    line.cov_alpha_r = t0 * line.var_alpha;
+    line.var_r = noise / n + t0 * t0 * line.var_alpha;
+    return line;
+}
+
+void LineExtractor::finish(vector<float> const& xs, vector<float> const& ys, vector<int> const& indices)
+{
+    for (int i=0; i<spans.size(); i++) {
+        Span const& s = spans[i];
+        if (s.b - s.a + 1 < min_points) {
+            continue;
+        }
+        LineSegment line = fit(s);
+        ofVec2f normal(cos(line.alpha), sin(line.alpha));
+        ofVec2f p(xs[indices[s.a]], ys[indices[s.a]]);
+        ofVec2f q(xs[indices[s.b]], ys[indices[s.b]]);
+        line.begin = p - normal * (p.dot(normal) - line.r);
+        line.end = q - normal * (q.dot(normal) - line.r);
+        if (line.length() < min_length) {
+            continue;
+        }
+        line.first = indices[s.a];
+        line.last = indices[s.b];
+        segments.push_back(line);
+    }
+}
+
+void LineExtractor::findCorners()
+{
+    float cos_limit = cos(ofDegToRad(corner_angle));
+    for (int i=0; i+1<segments.size(); i++) {
+        LineSegment const& a = segments[i];
+        LineSegment const& b = segments[i + 1];
+        if (a.end.distance(b.begin) > corner_distance) {
+            continue;
+        }
+        float ca = cos(a.alpha), sa = sin(a.alpha);
+        float cb = cos(b.alpha), sb = sin(b.alpha);
+        float c = fabs(ca * cb + sa * sb);
+        float det = ca * sb - sa * cb;
+        if (c > cos_limit || det == 0) {
+            continue;
+        }
+
+        Corner corner;
+        corner.position = ofVec2f((a.r * sb - b.r * sa) / det, (b.r * ca - a.r * cb) / det);
+        corner.angle = ofRadToDeg(acos(c));
+        corner.previous = i;
+        corner.next = i + 1;
+        corners.push_back(corner);
+    }
+}
+
+float LineExtractor::getWallAngle() const
+{
+    // circular mean of 4 * direction, so that the walls of every side agree
+    double c = 0, s = 0;
+    for (int i=0; i<segments.size(); i++) {
+        double w = segments[i].length();
+        c += w * cos(4 * segments[i].alpha);
+        s += w * sin(4 * segments[i].alpha);
+    }
+    if (c == 0 && s == 0) {
+        return 0;
+    }
+    return ofRadToDeg(atan2(s, c) / 4);
+}
+
+void LineExtractor::draw() const
+{
+    ofPushStyle();
+    ofSetLineWidth(2);
+    for (int i=0; i<segments.size(); i++) {
+        ofSetColor(ofColor::fromHsb((i*40) % 256, 255, 255));
+        ofLine(segments[i].begin.x, segments[i].begin.y, segments[i].end.x, segments[i].end.y);
+    }
+    ofNoFill();
+    ofSetColor(255);
+    for (int i=0; i<corners.size(); i++) {
+        ofCircle(corners[i].position.x, corners[i].position.y, 50);
+    }
+    ofPopStyle();
+}
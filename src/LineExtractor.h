@@ -0,0 +1,110 @@
+//
+//  LineExtractor.h
+//  example_ofxUrgDevice
+//
+//
+
+#ifndef __example_ofxUrgDevice__LineExtractor__
+#define __example_ofxUrgDevice__LineExtractor__
+
+#include "ofMain.h"
+#include "UrgData.h"
+
+namespace ofxUrg {
+
+    // a line in the coordinates of UrgData::getXsRef() [mm]:
+    // x * cos(alpha) + y * sin(alpha) = r, r >= 0
+    struct LineSegment
+    {
+        float alpha;            // [rad]
+        float r;                // [mm]
+        // covariance of (alpha, r): var alpha, cov, var r
+        float var_alpha;
+        float cov_alpha_r;
+        float var_r;
+        ofVec2f begin;          // the first and the last point projected on the line
+        ofVec2f end;
+        int first;              // beam indices
+        int last;
+        int count;              // number of points
+        float rms;              // distance of the points to the line [mm]
+
+        float length() const { return begin.distance(end); }
+    };
+
+    // the intersection of two adjacent segments
+    struct Corner
+    {
+        ofVec2f position;
+        float angle;            // between the segments, (0, 90] [degree]
+        int previous;           // indices of the segments
+        int next;
+    };
+
+    // split-and-merge over the valid points in scan order. runs of points
+    // are split at the point farthest from the chord while it is farther than
+    // split_distance, then adjacent segments are merged while they still fit
+    // one line. each fit is a total least squares fit from prefix sums of
+    // the cartesian view, so it costs O(1) and needs no trigonometry per point.
+    class LineExtractor
+    {
+    public:
+        LineExtractor();
+
+        // split_distance: largest distance of a point to its segment [mm]
+        // break_distance: neighbours farther than this are on different runs [mm]
+        // min_points, min_length [mm]: smaller segments are dropped
+        // sigma: range noise of the sensor, the lower bound of the covariance [mm]
+        void setup(float split_distance = 30, float break_distance = 150,
+                   int min_points = 8, float min_length = 200, float sigma = 10);
+        // adjacent segments meeting closer than distance [mm], at an angle
+        // larger than min_angle [degree], make a corner
+        void setCornerCondition(float distance = 150, float min_angle = 30);
+
+        void update(UrgData const& data);
+
+        vector<LineSegment> const& getSegmentsRef() const { return segments; }
+        vector<Corner> const& getCornersRef() const { return corners; }
+
+        // direction of the walls modulo 90 degree, weighted by the segment
+        // lengths, in (-45, 45] [degree]. adding it to the angle given to
+        // ofxUrgDevice::setSensorAngle() aligns the walls of a room to the axes.
+        float getWallAngle() const;
+
+        void draw() const;
+
+    private:
+        struct Span
+        {
+            int a;      // positions in the valid indices, inclusive
+            int b;
+            int run;    // runs are contiguous in the valid indices, spans only join within one
+        };
+
+        void buildSums(vector<float> const& xs, vector<float> const& ys, vector<int> const& indices);
+        void split(vector<float> const& xs, vector<float> const& ys, vector<int> const& indices, Span run);
+        void merge();
+        LineSegment fit(Span span) const;
+        void finish(vector<float> const& xs, vector<float> const& ys, vector<int> const& indices);
+        void findCorners();
+
+        float split_distance;
+        float break_distance;
+        int min_points;
+        float min_length;
+        float sigma;
+        float corner_distance;
+        float corner_angle;
+
+        vector<LineSegment> segments;
+        vector<Corner> corners;
+
+        // work area, reused between updates
+        vector<double> sx, sy, sxx, sxy, syy;   // prefix sums over the valid points
+        vector<Span> spans;
+        vector<Span> stack;
+    };
+
+}
+
+#endif /* defined(__example_ofxUrgDevice__LineExtractor__) */
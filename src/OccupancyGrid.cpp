@@ -0,0 +1,288 @@
+//
+//  OccupancyGrid.cpp
+//  example_ofxUrgDevice
+//
+//
+
+#include "OccupancyGrid.h"
+
+using namespace ofxUrg;
+
+void OccupancyGrid::Worker::threadedFunction()
+{
+    while (true) {
+        start.wait();
+        if (!isThreadRunning()) {
+            break;
+        }
+        cut = grid->cast(begin, end);
+        grid->done.post();
+    }
+}
+
+OccupancyGrid::OccupancyGrid()
+:resolution(50), max_range(30000), max_tiles(4096)
+,num_beams(0), num_cut_beams(0)
+,window_x(0), window_y(0), window_width(0), window_height(0)
+,done(0)
+{
+    setLogOdds();
+}
+
+OccupancyGrid::~OccupancyGrid()
+{
+    stopWorkers();
+    clear();
+}
+
+void OccupancyGrid::setup(float resolution_, int num_workers, int max_tiles_)
+{
+    stopWorkers();
+    clear();
+    resolution = max(resolution_, 1.0f);
+    max_tiles = max(max_tiles_, 1);
+
+    for (int i=0; i<num_workers; i++) {
+        Worker* worker = new Worker(this);
+        worker->startThread(true, false);
+        workers.push_back(worker);
+    }
+}
+
+void OccupancyGrid::setLogOdds(int hit, int miss, int lower_, int upper_)
+{
+    hit_step = hit;
+    miss_step = miss;
+    lower = max(lower_, SHRT_MIN);
+    upper = min(upper_, SHRT_MAX);
+}
+
+void OccupancyGrid::stopWorkers()
+{
+    for (int i=0; i<workers.size(); i++) {
+        Worker* worker = workers[i];
+        worker->stopThread();
+        // wakes it up to see the stop
+        worker->start.post();
+        worker->waitForThread(false);
+        delete worker;
+    }
+    workers.clear();
+}
+
+void OccupancyGrid::clear()
+{
+    for (std::map<long long, Tile*>::iterator it=tiles.begin(); it!=tiles.end(); ++it) {
+        delete it->second;
+    }
+    tiles.clear();
+    window.clear();
+    window_known.clear();
+    num_beams = 0;
+    num_cut_beams = 0;
+}
+
+void OccupancyGrid::update(UrgData const& data, SensorPose const& pose)
+{
+    vector<int> const& survivors = data.getValidIndicesRef();
+    vector<float> const& xs = data.getXsRef();
+    vector<float> const& ys = data.getYsRef();
+    vector<long> const& ranges = data.getDataRef();
+
+    // the rotation of the pose is already applied by setSensorAngle()
+    float scale = 1.0 / resolution;
+    Beam beam;
+    beam.x0 = floor(pose.x * scale);
+    beam.y0 = floor(pose.y * scale);
+    int min_x = beam.x0, max_x = beam.x0;
+    int min_y = beam.y0, max_y = beam.y0;
+
+    beams.clear();
+    for (int k=0; k<survivors.size(); k++) {
+        int i = survivors[k];
+        float x = xs[i];
+        float y = ys[i];
+        beam.hit = ranges[i] <= max_range;
+        if (!beam.hit) {
+            float shorten = max_range / ranges[i];
+            x *= shorten;
+            y *= shorten;
+        }
+        beam.x1 = floor((x + pose.x) * scale);
+        beam.y1 = floor((y + pose.y) * scale);
+        min_x = min(min_x, beam.x1);
+        max_x = max(max_x, beam.x1);
+        min_y = min(min_y, beam.y1);
+        max_y = max(max_y, beam.y1);
+        beams.push_back(beam);
+    }
+    if (beams.empty()) {
+        return;
+    }
+
+    prepare(min_x, min_y, max_x, max_y);
+
+    int n = beams.size();
+    if (workers.empty()) {
+        num_cut_beams += cast(0, n);
+    } else {
+        // contiguous blocks of beams, so that the workers mostly touch different tiles
+        int m = workers.size();
+        for (int w=0; w<m; w++) {
+            workers[w]->begin = n * w / m;
+            workers[w]->end = n * (w + 1) / m;
+            workers[w]->start.post();
+        }
+        for (int w=0; w<m; w++) {
+            done.wait();
+        }
+        for (int w=0; w<m; w++) {
+            num_cut_beams += workers[w]->cut;
+        }
+    }
+    num_beams += n;
+}
+
+// the tile bounds of the scan. the tiles are looked up by the beams.
+void OccupancyGrid::prepare(int min_x, int min_y, int max_x, int max_y)
+{
+    window_x = min_x >> TileBits;
+    window_y = min_y >> TileBits;
+    window_width = (max_x >> TileBits) - window_x + 1;
+    window_height = (max_y >> TileBits) - window_y + 1;
+    window.assign(window_width * window_height, NULL);
+    window_known.assign(window_width * window_height, false);
+}
+
+// once per tile a beam enters, so that the lock is rare next to the cells
+OccupancyGrid::Tile* OccupancyGrid::windowTile(int tx, int ty)
+{
+    int i = (ty - window_y) * window_width + (tx - window_x);
+    window_lock.lock();
+    if (!window_known[i]) {
+        long long k = key(tx, ty);
+        std::map<long long, Tile*>::iterator it = tiles.find(k);
+        if (it != tiles.end()) {
+            window[i] = it->second;
+        } else if (tiles.size() < max_tiles) {
+            window[i] = new Tile;
+            tiles[k] = window[i];
+        }
+        window_known[i] = true;
+    }
+    Tile* tile = window[i];
+    window_lock.unlock();
+    return tile;
+}
+
+// returns the number of beams that crossed a tile beyond max_tiles
+int OccupancyGrid::cast(int begin, int end)
+{
+    int cut = 0;
+    // the tile left last, as beams along a tile edge go back and forth,
+    // and every beam starts at the sensor
+    Tile* previous = NULL;
+    int previous_x = INT_MIN;
+    int previous_y = INT_MIN;
+    for (int b=begin; b<end; b++) {
+        Beam const& beam = beams[b];
+        int x = beam.x0;
+        int y = beam.y0;
+        int dx = abs(beam.x1 - x);
+        int dy = -abs(beam.y1 - y);
+        int sx = x < beam.x1 ? 1 : -1;
+        int sy = y < beam.y1 ? 1 : -1;
+        int error = dx + dy;
+
+        // the tile is kept locked while the beam stays in it
+        Tile* tile = NULL;
+        int tile_x = INT_MIN;
+        int tile_y = INT_MIN;
+        bool missed = false;
+        while (true) {
+            bool last = x == beam.x1 && y == beam.y1;
+            if (last && !beam.hit) {
+                break;
+            }
+            if ((x >> TileBits) != tile_x || (y >> TileBits) != tile_y) {
+                if (tile) tile->lock.unlock();
+                int next_x = x >> TileBits;
+                int next_y = y >> TileBits;
+                Tile* next = (next_x == previous_x && next_y == previous_y) ? previous : windowTile(next_x, next_y);
+                if (tile_x != INT_MIN) {
+                    previous = tile;
+                    previous_x = tile_x;
+                    previous_y = tile_y;
+                }
+                tile = next;
+                tile_x = next_x;
+                tile_y = next_y;
+                if (tile) {
+                    tile->lock.lock();
+                } else {
+                    missed = true;
+                }
+            }
+            if (tile) {
+                short& cell = tile->cells[((y & (TileSize - 1)) << TileBits) | (x & (TileSize - 1))];
+                cell = min(max(cell + (last ? hit_step : miss_step), lower), upper);
+            }
+            if (last) {
+                break;
+            }
+
+            int e2 = 2 * error;
+            if (e2 >= dy) {
+                error += dy;
+                x += sx;
+            }
+            if (e2 <= dx) {
+                error += dx;
+                y += sy;
+            }
+        }
+        if (tile) tile->lock.unlock();
+        if (tile_x != INT_MIN) {
+            previous = tile;
+            previous_x = tile_x;
+            previous_y = tile_y;
+        }
+        if (missed) cut++;
+    }
+    return cut;
+}
+
+int OccupancyGrid::getLogOdds(float x, float y) const
+{
+    int cx = floor(x / resolution);
+    int cy = floor(y / resolution);
+    std::map<long long, Tile*>::const_iterator it = tiles.find(key(cx >> TileBits, cy >> TileBits));
+    if (it == tiles.end()) {
+        return 0;
+    }
+    return it->second->cells[((cy & (TileSize - 1)) << TileBits) | (cx & (TileSize - 1))];
+}
+
+float OccupancyGrid::getProbability(float x, float y) const
+{
+    return 1.0 - 1.0 / (1.0 + exp(getLogOdds(x, y) / 100.0));
+}
+
+void OccupancyGrid::draw() const
+{
+    ofPushStyle();
+    ofFill();
+    for (std::map<long long, Tile*>::const_iterator it=tiles.begin(); it!=tiles.end(); ++it) {
+        int tx = keyX(it->first);
+        int ty = keyY(it->first);
+        short const* cells = it->second->cells;
+        for (int i=0; i<TileSize * TileSize; i++) {
+            if (cells[i] <= 0) continue;
+            int x = tx * TileSize + (i & (TileSize - 1));
+            int y = ty * TileSize + (i >> TileBits);
+            ofSetColor(255 * min(cells[i], (short)upper) / max(upper, 1));
+            ofRect(x * resolution, y * resolution, resolution, resolution);
+        }
+    }
+    ofPopStyle();
+}
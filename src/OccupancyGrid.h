@@ -0,0 +1,134 @@
+//
+//  OccupancyGrid.h
+//  example_ofxUrgDevice
+//
+//
+
+#ifndef __example_ofxUrgDevice__OccupancyGrid__
+#define __example_ofxUrgDevice__OccupancyGrid__
+
+#include "ofMain.h"
+#include "UrgData.h"
+#include "SensorPose.h"
+#include "Lock.h"
+#include "Semaphore.h"
+#include <map>
+
+namespace ofxUrg {
+
+    // log-odds occupancy of the floor in world coordinates [mm].
+    // cells are stored in tiles of TileSize x TileSize, allocated when a beam
+    // first reaches them, so only the mapped area takes memory.
+    // each beam is raycast with integer Bresenham steps: the cells it crosses
+    // get a miss, the cell it ends in gets a hit. beams are split between
+    // worker threads, which lock a tile while they update its cells.
+    // once max_tiles are allocated, the beams stop at the edge of the mapped
+    // tiles, and are counted by getNumCutBeams().
+    class OccupancyGrid
+    {
+    public:
+        enum { TileBits = 6, TileSize = 1 << TileBits };
+
+        OccupancyGrid();
+        ~OccupancyGrid();
+
+        // resolution: cell size [mm]. workers: raycasting threads, 0 runs on
+        // the calling thread. max_tiles: beams into new tiles beyond it are cut.
+        void setup(float resolution = 50, int workers = 4, int max_tiles = 4096);
+        // log-odds in 1/100: added by a hit and a miss, and the limits of a cell
+        void setLogOdds(int hit = 85, int miss = -40, int lower = -2000, int upper = 3500);
+        // farther beams are cast up to the range without a hit [mm]
+        void setMaxRange(float range) { max_range = range; }
+
+        // integrates the valid beams of the scan. the pose moves the scan the
+        // same way as ofxUrgManager. returns after every beam is cast.
+        void update(UrgData const& data, SensorPose const& pose = SensorPose());
+        void clear();
+
+        // log-odds of the cell at the world position, 0 when unknown
+        int getLogOdds(float x, float y) const;
+        // 0.5 when unknown
+        float getProbability(float x, float y) const;
+        float getResolution() const { return resolution; }
+        int getNumTiles() const { return tiles.size(); }
+        // beams integrated since setup() or clear()
+        unsigned long long getNumBeams() const { return num_beams; }
+        // beams that crossed a tile beyond max_tiles, which was not updated
+        unsigned long long getNumCutBeams() const { return num_cut_beams; }
+
+        // draws the occupied cells
+        void draw() const;
+
+    private:
+        OccupancyGrid(OccupancyGrid const&);
+        OccupancyGrid& operator=(OccupancyGrid const&);
+
+        struct Tile
+        {
+            short cells[TileSize * TileSize];
+            qrk::Lock lock;
+
+            Tile() { fill(cells, cells + TileSize * TileSize, 0); }
+        };
+
+        // waits for a block of beams, casts it, and reports to the grid
+        struct Worker : public ofThread
+        {
+            OccupancyGrid* grid;
+            int begin;
+            int end;
+            int cut;
+            qrk::Semaphore start;
+
+            Worker(OccupancyGrid* grid_) : grid(grid_), begin(0), end(0), cut(0), start(0) {}
+            void threadedFunction();
+        };
+        friend struct Worker;
+
+        // cells of the sensor and of the end of the beam
+        struct Beam
+        {
+            int x0, y0;
+            int x1, y1;
+            bool hit;
+        };
+
+        // shifted as unsigned, negative tile coordinates included
+        static long long key(int tx, int ty)
+        {
+            return (long long)(((unsigned long long)(unsigned int)tx << 32) | (unsigned int)ty);
+        }
+        static int keyX(long long k) { return (int)(unsigned int)((unsigned long long)k >> 32); }
+        static int keyY(long long k) { return (int)(unsigned int)k; }
+        void stopWorkers();
+        void prepare(int min_x, int min_y, int max_x, int max_y);
+        Tile* windowTile(int tx, int ty);
+        int cast(int begin, int end);
+
+        float resolution;
+        float max_range;
+        int max_tiles;
+        int hit_step;
+        int miss_step;
+        int lower;
+        int upper;
+
+        std::map<long long, Tile*> tiles;
+        unsigned long long num_beams;
+        unsigned long long num_cut_beams;
+
+        // the tiles around the current scan, row-major, looked up or allocated
+        // by the first beam into them under window_lock. NULL beyond max_tiles.
+        vector<Tile*> window;
+        vector<char> window_known;
+        qrk::Lock window_lock;
+        int window_x, window_y, window_width, window_height;
+        vector<Beam> beams;
+
+        vector<Worker*> workers;
+        qrk::Semaphore done;
+    };
+
+}
+
+#endif /* defined(__example_ofxUrgDevice__OccupancyGrid__) */
@@ -0,0 +1,93 @@
+//
+//  OutlierFilter.cpp
+//  example_ofxUrgDevice
+//
+//
+
+#include "OutlierFilter.h"
+
+using namespace ofxUrg;
+
+OutlierFilter::OutlierFilter()
+{
+    setup();
+}
+
+void OutlierFilter::setup(float min_angle, int window_, float isolated_distance_)
+{
+    tan_min_angle = min_angle > 0 ? tan(ofDegToRad(min_angle)) : 0;
+    window = max(window_, 1);
+    isolated_distance = max(isolated_distance_, 0.0f);
+}
+
+void OutlierFilter::update(UrgData const& data)
+{
+    vector<long> const& d = data.getDataRef();
+    vector<float> const& angles = data.getDataAnglesRef();
+    int n = min(d.size(), angles.size());
+    outliers.resize(n);
+    if (n < 2) {
+        return;
+    }
+
+    ranges.resize(n);
+    veiling.assign(n, 0);
+    connected.assign(n, 0);
+    supported.assign(n, 0);
+    for (int i=0; i<n; i++) {
+        ranges[i] = data.isValid(i) ? d[i] : 0;
+    }
+
+    float step = fabs(angles[n - 1] - angles[0]) / (n - 1);
+    float const* r = &ranges[0];
+    unsigned char* veil = &veiling[0];
+    unsigned char* linked = &connected[0];
+    unsigned char* solid = &supported[0];
+
+    // one offset at a time, so that the inner loop runs over contiguous
+    // arrays without branches
+    for (int k=1; k<=window && k<n; k++) {
+        float c = cos(k * step);
+        float s = sin(k * step);
+        for (int i=0; i+k<n; i++) {
+            float a = r[i];
+            float b = r[i + k];
+            bool both = (a > 0) & (b > 0);
+
+            // b seen from a: across the beam and along the beam
+            float across = b * s;
+            float along = fabs(a - b * c);
+            unsigned char v = both & (across < tan_min_angle * along);
+            veil[i] |= v;
+            veil[i + k] |= v;
+
+            // beams spread with the range, the limit grows by two spacings
+            float limit = isolated_distance + 2 * min(a, b) * s;
+            float distance2 = a * a + b * b - 2 * a * b * c;
+            unsigned char close = both & (distance2 < limit * limit);
+            linked[i] |= close;
+            linked[i + k] |= close;
+            // a close neighbour on the same surface
+            unsigned char surface = close & !v;
+            solid[i] |= surface;
+            solid[i + k] |= surface;
+        }
+    }
+
+    // the two beams of a veiling pair are both suspects. the one still on a
+    // surface with another neighbour (the edge of the object, or the
+    // background) is kept.
+    bool isolation = isolated_distance > 0;
+    for (int i=0; i<n; i++) {
+        bool veiled = veiling[i] & !supported[i];
+        bool isolated = isolation & !connected[i];
+        bool outlier = (ranges[i] > 0) & (veiled | isolated);
+        outliers.set(i, outlier);
+    }
+}
+
+void OutlierFilter::apply(UrgData& data)
+{
+    update(data);
+    data.invalidate(outliers);
+}
@@ -0,0 +1,56 @@
+//
+//  OutlierFilter.h
+//  example_ofxUrgDevice
+//
+//
+
+#ifndef __example_ofxUrgDevice__OutlierFilter__
+#define __example_ofxUrgDevice__OutlierFilter__
+
+#include "ofMain.h"
+#include "UrgData.h"
+#include "BeamMask.h"
+
+namespace ofxUrg {
+
+    // finds beams that are not on a real surface:
+    // - veiling (mixed pixels): the beam hits the edge of a near object and
+    //   returns a range between the object and the background. the segments
+    //   to its neighbours are nearly parallel to the beam.
+    // - isolated points: no valid neighbour nearer than isolated_distance.
+    // beams are assumed evenly spaced, so the test needs no trigonometry per beam.
+    class OutlierFilter
+    {
+    public:
+        OutlierFilter();
+
+        // min_angle: a segment to a neighbour closer to the beam direction than
+        // this is veiling [degree], 0 disables the test. beams with a veiling
+        // segment and no other close neighbour are removed.
+        // window: neighbours tested on each side.
+        // isolated_distance: 0 disables the test [mm]. two beam spacings
+        // at the range are added, so far surfaces stay connected.
+        void setup(float min_angle = 10, int window = 1, float isolated_distance = 100);
+
+        // tests the valid beams of the scan
+        void update(UrgData const& data);
+        // update(), then marks the outliers invalid
+        void apply(UrgData& data);
+
+        BeamMask const& getOutliersRef() const { return outliers; }
+
+    private:
+        float tan_min_angle;
+        int window;
+        float isolated_distance;
+
+        BeamMask outliers;
+        vector<float> ranges;           // 0 for invalid beams
+        vector<unsigned char> veiling;
+        vector<unsigned char> connected;    // a close neighbour
+        vector<unsigned char> supported;    // a close neighbour without veiling
+    };
+
+}
+
+#endif /* defined(__example_ofxUrgDevice__OutlierFilter__) */
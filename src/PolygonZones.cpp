@@ -0,0 +1,164 @@
+//
+//  PolygonZones.cpp
+//  example_ofxUrgDevice
+//
+//
+
+#include "PolygonZones.h"
+
+using namespace ofxUrg;
+
+int PolygonZones::addZone(vector<ofVec2f> const& polygon)
+{
+    Zone zone;
+    zone.polygon = polygon;
+    zone.layers = 0;
+    zones.push_back(zone);
+    compiled_dirty = true;
+    return zones.size() - 1;
+}
+
+int PolygonZones::addZone(ofPolyline const& polygon)
+{
+    vector<ofPoint> const& vertices = polygon.getVertices();
+    vector<ofVec2f> points;
+    for (int i=0; i<vertices.size(); i++) {
+        points.push_back(ofVec2f(vertices[i].x, vertices[i].y));
+    }
+    return addZone(points);
+}
+
+void PolygonZones::clear()
+{
+    zones.clear();
+    hits.clear();
+    counts.clear();
+    compiled_dirty = true;
+}
+
+void PolygonZones::compile(UrgData const& data)
+{
+    vector<float> const& cosines = data.getCosRef();
+    vector<float> const& sines = data.getSinRef();
+    num_beams = cosines.size();
+    for (int z=0; z<zones.size(); z++) {
+        compileZone(zones[z], cosines, sines);
+    }
+    compiled_table = data.getAngleTable();
+    compiled_dirty = false;
+}
+
+void PolygonZones::compileZone(Zone& zone, vector<float> const& cosines, vector<float> const& sines)
+{
+    vector<ofVec2f> const& p = zone.polygon;
+    int m = p.size();
+    
+    // the sensor at the origin is inside when a ray from it crosses the
+    // edges an odd number of times
+    bool sensor_inside = false;
+    for (int j=0; j<m; j++) {
+        ofVec2f a = p[j];
+        ofVec2f b = p[(j + 1) % m];
+        if ((a.y > 0) != (b.y > 0) && a.x - a.y * (b.x - a.x) / (b.y - a.y) > 0) {
+            sensor_inside = !sensor_inside;
+        }
+    }
+    
+    // crossings of each beam with the edges, from the sensor at the origin.
+    // an edge crosses the beam when its ends are on opposite sides of it,
+    // a point on the beam counting as the right side, so that a vertex
+    // touched by the beam is crossed twice or not at all.
+    vector<vector<float> > crossings(num_beams);
+    int layers = 0;
+    for (int i=0; i<num_beams; i++) {
+        ofVec2f dir(cosines[i], -sines[i]);
+        vector<float>& t = crossings[i];
+        for (int j=0; j<m; j++) {
+            ofVec2f a = p[j];
+            ofVec2f b = p[(j + 1) % m];
+            float side_a = dir.x * a.y - dir.y * a.x;
+            float side_b = dir.x * b.y - dir.y * b.x;
+            if ((side_a > 0) == (side_b > 0)) continue;
+            float u = side_a / (side_a - side_b);   // along the edge
+            float s = dir.dot(a + (b - a) * u);     // along the beam
+            if (s >= 0) {
+                t.push_back(s);
+            }
+        }
+        sort(t.begin(), t.end());
+        if (sensor_inside) {
+            t.insert(t.begin(), 0);
+        }
+        // a sensor exactly on an edge can leave one crossing without a pair
+        t.resize(t.size() / 2 * 2);
+        layers = max(layers, (int) t.size() / 2);
+    }
+    
+    zone.layers = layers;
+    zone.enter.assign(layers * num_beams, FLT_MAX);
+    zone.exit.assign(layers * num_beams, -FLT_MAX);
+    for (int i=0; i<num_beams; i++) {
+        vector<float> const& t = crossings[i];
+        for (int k=0; k<t.size()/2; k++) {
+            zone.enter[k * num_beams + i] = t[2*k];
+            zone.exit[k * num_beams + i] = t[2*k + 1];
+        }
+    }
+}
+
+void PolygonZones::update(UrgData const& data)
+{
+    if (compiled_dirty || compiled_table != data.getAngleTable()) {
+        compile(data);
+    }
+    
+    vector<long> const& d = data.getDataRef();
+    int n = min((int) d.size(), num_beams);
+    ranges.assign(d.begin(), d.begin() + n);
+    inside.resize(n);
+    vector<int> const& survivors = data.getValidIndicesRef();
+    
+    hits.resize(zones.size());
+    counts.assign(zones.size(), 0);
+    for (int z=0; z<zones.size(); z++) {
+        Zone const& zone = zones[z];
+        if (n == 0 || zone.layers == 0) continue;
+        
+        // plain loops over the tables, for the compiler to vectorize
+        float const* r = &ranges[0];
+        unsigned char* in = &inside[0];
+        fill(inside.begin(), inside.end(), 0);
+        for (int k=0; k<zone.layers; k++) {
+            float const* enter = &zone.enter[k * num_beams];
+            float const* exit = &zone.exit[k * num_beams];
+            for (int i=0; i<n; i++) {
+                in[i] |= (r[i] >= enter[i]) & (r[i] <= exit[i]);
+            }
+        }
+        
+        int count = 0;
+        for (int k=0; k<survivors.size() && survivors[k] < n; k++) {
+            count += in[survivors[k]];
+        }
+        counts[z] = count;
+        if (count > 0) {
+            hits.set(z);
+        }
+    }
+}
+
+void PolygonZones::draw() const
+{
+    ofPushStyle();
+    for (int z=0; z<zones.size(); z++) {
+        vector<ofVec2f> const& p = zones[z].polygon;
+        bool hit = z < hits.size() && hits.test(z);
+        ofSetColor(ofColor::fromHsb((z*60 + 40) % 256, 255, 255, hit ? 255 : 100));
+        ofSetLineWidth(hit ? 3 : 1);
+        for (int j=0; j<p.size(); j++) {
+            ofVec2f const& q = p[(j + 1) % p.size()];
+            ofLine(p[j].x, p[j].y, q.x, q.y);
+        }
+    }
+    ofPopStyle();
+}
@@ -0,0 +1,68 @@
+//
+//  PolygonZones.h
+//  example_ofxUrgDevice
+//
+//
+
+#ifndef __example_ofxUrgDevice__PolygonZones__
+#define __example_ofxUrgDevice__PolygonZones__
+
+#include "ofMain.h"
+#include "UrgData.h"
+#include "BeamMask.h"
+
+namespace ofxUrg {
+
+    // detection zones of any polygon shape (concave included), in the
+    // coordinates of UrgData::getXsRef()/getYsRef() [mm].
+    // each zone is compiled into [enter, exit] distance intervals of every
+    // beam, so that a scan is tested by range comparisons only.
+    class PolygonZones
+    {
+    public:
+        PolygonZones() : compiled_dirty(true), num_beams(0) {}
+        
+        int addZone(vector<ofVec2f> const& polygon);
+        int addZone(ofPolyline const& polygon);
+        void clear();
+        int size() const { return zones.size(); }
+        vector<ofVec2f> const& getPolygonRef(int zone) const { return zones[zone].polygon; }
+        
+        // tests the valid beams of the scan against every zone
+        void update(UrgData const& data);
+        
+        // bit z is set when a valid beam is inside the zone z
+        BeamMask const& getHitsRef() const { return hits; }
+        // number of valid beams inside each zone
+        vector<int> const& getCountsRef() const { return counts; }
+        
+        void draw() const;
+        
+    private:
+        struct Zone
+        {
+            vector<ofVec2f> polygon;
+            // layers * num_beams intervals, beam fastest.
+            // empty intervals have enter > exit.
+            int layers;
+            vector<float> enter;
+            vector<float> exit;
+        };
+        
+        void compile(UrgData const& data);
+        void compileZone(Zone& zone, vector<float> const& cosines, vector<float> const& sines);
+        
+        vector<Zone> zones;
+        AngleTablePtr compiled_table;
+        bool compiled_dirty;
+        int num_beams;
+        
+        BeamMask hits;
+        vector<int> counts;
+        vector<float> ranges;
+        vector<unsigned char> inside;
+    };
+
+}
+
+#endif /* defined(__example_ofxUrgDevice__PolygonZones__) */
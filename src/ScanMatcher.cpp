@@ -0,0 +1,188 @@
+//
+//  ScanMatcher.cpp
+//  example_ofxUrgDevice
+//
+//
+
+#include "ScanMatcher.h"
+
+using namespace ofxUrg;
+
+namespace {
+
+    // solves the 3x3 symmetric system a x = b, false when it is singular
+    bool solve3(double a[3][3], double b[3], double x[3])
+    {
+        double det =
+            a[0][0] * (a[1][1] * a[2][2] - a[1][2] * a[2][1]) -
+            a[0][1] * (a[1][0] * a[2][2] - a[1][2] * a[2][0]) +
+            a[0][2] * (a[1][0] * a[2][1] - a[1][1] * a[2][0]);
+        if (fabs(det) < 1e-12) {
+            return false;
+        }
+        for (int c=0; c<3; c++) {
+            double m[3][3];
+            for (int i=0; i<3; i++) {
+                for (int j=0; j<3; j++) {
+                    m[i][j] = (j == c) ? b[i] : a[i][j];
+                }
+            }
+            x[c] = (m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) -
+                    m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+                    m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0])) / det;
+        }
+        return true;
+    }
+
+}
+
+ScanMatcher::ScanMatcher()
+:error(0), num_pairs(0), iterations(0)
+{
+    setup();
+}
+
+void ScanMatcher::setup(int max_iterations_, float max_distance_, float tolerance_)
+{
+    max_iterations = max(max_iterations_, 1);
+    max_distance = max(max_distance_, 1.0f);
+    tolerance = tolerance_;
+    // cells of the query radius
+    index.setup(max_distance);
+}
+
+void ScanMatcher::setReference(vector<ofVec2f> const& points)
+{
+    int n = points.size();
+    ref_x.resize(n);
+    ref_y.resize(n);
+    normal_x.assign(n, 0);
+    normal_y.assign(n, 0);
+    for (int i=0; i<n; i++) {
+        ref_x[i] = points[i].x;
+        ref_y[i] = points[i].y;
+    }
+
+    // the surface runs from the previous to the next point, when both are near
+    float near2 = max_distance * max_distance * 0.25;
+    for (int i=0; i<n; i++) {
+        ofVec2f a = points[i > 0 ? i - 1 : i];
+        ofVec2f b = points[i + 1 < n ? i + 1 : i];
+        if ((a - points[i]).squareLength() > near2 || (b - points[i]).squareLength() > near2) {
+            continue;
+        }
+        ofVec2f d = b - a;
+        float length = d.length();
+        if (length > 0) {
+            normal_x[i] = -d.y / length;
+            normal_y[i] = d.x / length;
+        }
+    }
+    index.build(points);
+}
+
+void ScanMatcher::setReference(UrgData const& data, SensorPose const& at)
+{
+    // the rotation of the pose is already applied by setSensorAngle()
+    vector<int> const& survivors = data.getValidIndicesRef();
+    vector<float> const& xs = data.getXsRef();
+    vector<float> const& ys = data.getYsRef();
+    vector<ofVec2f> points(survivors.size());
+    for (int k=0; k<survivors.size(); k++) {
+        points[k] = ofVec2f(xs[survivors[k]] + at.x, ys[survivors[k]] + at.y);
+    }
+    setReference(points);
+}
+
+bool ScanMatcher::match(UrgData const& data, SensorPose const& guess)
+{
+    vector<int> const& survivors = data.getValidIndicesRef();
+    vector<float> const& xs = data.getXsRef();
+    vector<float> const& ys = data.getYsRef();
+    int n = survivors.size();
+    px.resize(n);
+    py.resize(n);
+    qx.resize(n);
+    qy.resize(n);
+    for (int k=0; k<n; k++) {
+        px[k] = xs[survivors[k]];
+        py[k] = ys[survivors[k]];
+    }
+
+    // the scan is already rotated by its sensor angle. a larger sensor angle
+    // turns the screen points clockwise, so the extra rotation is the difference.
+    double theta = ofDegToRad(data.getSensorAngle() - guess.angle);
+    double tx = guess.x;
+    double ty = guess.y;
+    double step_angle = tolerance / 1000.0;
+
+    num_pairs = 0;
+    error = 0;
+    for (iterations=0; iterations<max_iterations; ) {
+        iterations++;
+
+        // moves the scan, in plain loops over contiguous arrays
+        float c = cos(theta);
+        float s = sin(theta);
+        for (int k=0; k<n; k++) {
+            qx[k] = c * px[k] - s * py[k] + tx;
+        }
+        for (int k=0; k<n; k++) {
+            qy[k] = s * px[k] + c * py[k] + ty;
+        }
+
+        // normal equations of the linearized point-to-line distances
+        double a[3][3] = { { 0 } };
+        double b[3] = { 0 };
+        double squares = 0;
+        num_pairs = 0;
+        for (int k=0; k<n; k++) {
+            int i = index.findNearest(ofVec2f(qx[k], qy[k]), max_distance);
+            if (i < 0 || (normal_x[i] == 0 && normal_y[i] == 0)) {
+                continue;
+            }
+            float nx = normal_x[i];
+            float ny = normal_y[i];
+            double e = nx * (qx[k] - ref_x[i]) + ny * (qy[k] - ref_y[i]);
+            double j[3] = { nx * -qy[k] + ny * qx[k], nx, ny };
+            for (int r=0; r<3; r++) {
+                for (int q=0; q<3; q++) {
+                    a[r][q] += j[r] * j[q];
+                }
+                b[r] -= j[r] * e;
+            }
+            squares += e * e;
+            num_pairs++;
+        }
+        if (num_pairs < 3) {
+            break;
+        }
+        error = sqrt(squares / num_pairs);
+
+        // a little damping keeps the system solvable when the scene fixes
+        // only some directions, e.g. a single wall
+        for (int r=0; r<3; r++) {
+            a[r][r] *= 1 + 1e-6;
+        }
+        double x[3];
+        if (!solve3(a, b, x)) {
+            break;
+        }
+
+        // applies the step on top of the current estimate
+        double dc = cos(x[0]);
+        double ds = sin(x[0]);
+        double ntx = dc * tx - ds * ty + x[1];
+        double nty = ds * tx + dc * ty + x[2];
+        theta += x[0];
+        tx = ntx;
+        ty = nty;
+
+        if (fabs(x[0]) < step_angle && fabs(x[1]) < tolerance && fabs(x[2]) < tolerance) {
+            break;
+        }
+    }
+
+    pose = SensorPose(tx, ty, data.getSensorAngle() - ofRadToDeg(theta));
+    return num_pairs >= 3;
+}
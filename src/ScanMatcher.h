@@ -0,0 +1,70 @@
+//
+//  ScanMatcher.h
+//  example_ofxUrgDevice
+//
+//
+
+#ifndef __example_ofxUrgDevice__ScanMatcher__
+#define __example_ofxUrgDevice__ScanMatcher__
+
+#include "ofMain.h"
+#include "UrgData.h"
+#include "SensorPose.h"
+#include "SpatialIndex.h"
+
+namespace ofxUrg {
+
+    // estimates the pose of a sensor by aligning its scan to a reference
+    // (the scan of an overlapping sensor, or a recorded one) with
+    // point-to-line ICP. each point is paired with the nearest reference
+    // point, found in a SpatialIndex, and the distance to the line through
+    // it is minimized. iterations stop when the step gets below the tolerance.
+    class ScanMatcher
+    {
+    public:
+        ScanMatcher();
+
+        // max_distance: pairs farther than this are left out [mm]
+        // tolerance: stops when a step moves the points within 1 m by less than this [mm]
+        void setup(int max_iterations = 30, float max_distance = 300, float tolerance = 0.5);
+
+        // reference points in world coordinates [mm], in scan order so that
+        // the neighbours of a point give the direction of its surface
+        void setReference(vector<ofVec2f> const& points);
+        void setReference(UrgData const& data, SensorPose const& pose = SensorPose());
+
+        // aligns the valid points of the scan to the reference, starting from
+        // the guess. returns false when too few points are paired.
+        bool match(UrgData const& data, SensorPose const& guess);
+
+        // the pose of the scan: place it with ofxUrgManager::setPose(), or
+        // pose.angle with ofxUrgDevice::setSensorAngle()
+        SensorPose const& getPose() const { return pose; }
+        // rms distance of the paired points to their lines [mm]
+        float getError() const { return error; }
+        int getNumPairs() const { return num_pairs; }
+        int getIterations() const { return iterations; }
+
+    private:
+        int max_iterations;
+        float max_distance;
+        float tolerance;
+
+        SensorPose pose;
+        float error;
+        int num_pairs;
+        int iterations;
+
+        // reference points and the normals of their surfaces, (0, 0) when unknown
+        vector<float> ref_x, ref_y;
+        vector<float> normal_x, normal_y;
+        SpatialIndex index;
+
+        // the scan in the sensor frame, and moved by the current estimate
+        vector<float> px, py;
+        vector<float> qx, qy;
+    };
+
+}
+
+#endif /* defined(__example_ofxUrgDevice__ScanMatcher__) */
@@ -0,0 +1,159 @@
+//
+//  ScanSegmenter.cpp
+//  example_ofxUrgDevice
+//
+//
+
+#include "ScanSegmenter.h"
+
+using namespace ofxUrg;
+
+ScanSegmenter::ScanSegmenter()
+{
+    setup();
+    clusters.reserve(64);
+}
+
+void ScanSegmenter::setup(float lambda_, float sigma_, int min_points_, int max_gap_)
+{
+    lambda = ofDegToRad(lambda_);
+    sigma = sigma_;
+    min_points = max(min_points_, 1);
+    max_gap = max(max_gap_, 0);
+    ratios.clear();
+}
+
+void ScanSegmenter::updateRatios(UrgData const& data)
+{
+    if (!ratios.empty() && ratio_table == data.getAngleTable()) {
+        return;
+    }
+    ratio_table = data.getAngleTable();
+    vector<float> const& angles = data.getDataAnglesRef();
+    int beams = angles.size();
+    float step = beams > 1 ? fabs(angles.back() - angles.front()) / (beams - 1) : 0;
+    ratios.resize(max_gap + 2);
+    for (int g=0; g<ratios.size(); g++) {
+        ratios[g] = breakRatio(g * step);
+    }
+}
+
+// -1 when the beams are too far apart to see one surface
+float ScanSegmenter::breakRatio(float dphi) const
+{
+    return dphi >= lambda ? -1 : sin(dphi) / sin(lambda - dphi);
+}
+
+bool ScanSegmenter::isBreak(UrgData const& data, int i, int j, float ratio) const
+{
+    if (ratio < 0) {
+        return true;
+    }
+    vector<long> const& r = data.getDataRef();
+    float threshold = min(r[i], r[j]) * ratio + 3 * sigma;
+    ofVec2f a = data.getPoint(i);
+    ofVec2f b = data.getPoint(j);
+    return (a - b).squareLength() > threshold * threshold;
+}
+
+void ScanSegmenter::begin(UrgData const& data, int i)
+{
+    current.first = i;
+    current.last = i;
+    current.count = 0;
+    ofVec2f p = data.getPoint(i);
+    current.bounds = ofRectangle(p.x, p.y, 0, 0);
+    sum = ofVec2f();
+    add(data, i);
+}
+
+void ScanSegmenter::add(UrgData const& data, int i)
+{
+    ofVec2f p = data.getPoint(i);
+    current.last = i;
+    current.count++;
+    sum = sum + p;
+    
+    ofRectangle& b = current.bounds;
+    float x1 = min(b.x, p.x);
+    float y1 = min(b.y, p.y);
+    float x2 = max(b.x + b.width, p.x);
+    float y2 = max(b.y + b.height, p.y);
+    b = ofRectangle(x1, y1, x2 - x1, y2 - y1);
+}
+
+void ScanSegmenter::finish()
+{
+    // the sum is kept in the centroid until mergeWrapped()
+    current.centroid = sum;
+    clusters.push_back(current);
+}
+
+void ScanSegmenter::update(UrgData const& data)
+{
+    clusters.clear();
+    vector<int> const& survivors = data.getValidIndicesRef();
+    if (survivors.empty()) {
+        return;
+    }
+    updateRatios(data);
+    
+    begin(data, survivors[0]);
+    for (int k=1; k<survivors.size(); k++) {
+        int i = survivors[k - 1];
+        int j = survivors[k];
+        if (j - i - 1 > max_gap || isBreak(data, i, j, ratios[j - i])) {
+            finish();
+            begin(data, j);
+        } else {
+            add(data, j);
+        }
+    }
+    finish();
+    
+    mergeWrapped(data);
+    
+    // drops small clusters in place, and turns the sums into centroids
+    int n = 0;
+    for (int k=0; k<clusters.size(); k++) {
+        if (clusters[k].count < min_points) continue;
+        clusters[n] = clusters[k];
+        clusters[n].centroid = clusters[k].centroid * (1.0 / clusters[k].count);
+        n++;
+    }
+    clusters.resize(n);
+}
+
+// the last and the first beams face each other across the back of the
+// sensor. they are adjacent only when the scan covers nearly a full turn.
+void ScanSegmenter::mergeWrapped(UrgData const& data)
+{
+    if (clusters.size() < 2) {
+        return;
+    }
+    vector<float> const& angles = data.getDataAnglesRef();
+    Cluster& head = clusters.front();
+    Cluster& tail = clusters.back();
+    int beams = angles.size();
+    if ((beams - 1 - tail.last) + head.first > max_gap) {
+        return;
+    }
+    float span = angles.back() - angles.front();
+    float step = span / max(beams - 1, 1);
+    float dphi = TWO_PI - span + step * ((beams - 1 - tail.last) + head.first);
+    if (dphi < 0 || isBreak(data, tail.last, head.first, breakRatio(dphi))) {
+        return;
+    }
+    
+    tail.last = head.last;
+    tail.count += head.count;
+    tail.centroid = tail.centroid + head.centroid;
+    ofRectangle const& a = tail.bounds;
+    ofRectangle const& b = head.bounds;
+    float x1 = min(a.x, b.x);
+    float y1 = min(a.y, b.y);
+    float x2 = max(a.x + a.width, b.x + b.width);
+    float y2 = max(a.y + a.height, b.y + b.height);
+    tail.bounds = ofRectangle(x1, y1, x2 - x1, y2 - y1);
+    clusters.erase(clusters.begin());
+}
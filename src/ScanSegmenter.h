@@ -0,0 +1,70 @@
+//
+//  ScanSegmenter.h
+//  example_ofxUrgDevice
+//
+//
+
+#ifndef __example_ofxUrgDevice__ScanSegmenter__
+#define __example_ofxUrgDevice__ScanSegmenter__
+
+#include "ofMain.h"
+#include "UrgData.h"
+
+namespace ofxUrg {
+
+    // points of one object, in the coordinates of UrgData::getXsRef() [mm]
+    struct Cluster
+    {
+        int first;          // beam index, first > last when wrapped around the back
+        int last;
+        int count;          // number of valid beams
+        ofVec2f centroid;
+        ofRectangle bounds;
+    };
+    
+    // splits a scan into clusters in one pass over the valid beams, with the
+    // adaptive breakpoint detection (Borges and Aldon, 2004): adjacent beams
+    // belong to the same object unless their distance exceeds
+    //   r * sin(dphi) / sin(lambda - dphi) + 3 * sigma
+    class ScanSegmenter
+    {
+    public:
+        ScanSegmenter();
+        
+        // lambda: worst incidence angle of a surface still seen as continuous [degree]
+        // sigma: range noise [mm], min_points: smaller clusters are dropped,
+        // max_gap: number of invalid beams allowed inside a cluster
+        void setup(float lambda = 10, float sigma = 10, int min_points = 3, int max_gap = 2);
+        
+        void update(UrgData const& data);
+        
+        // the clusters of the last update(). the vector is reused between frames.
+        vector<Cluster> const& getClustersRef() const { return clusters; }
+        
+    private:
+        void updateRatios(UrgData const& data);
+        float breakRatio(float dphi) const;
+        bool isBreak(UrgData const& data, int i, int j, float ratio) const;
+        void begin(UrgData const& data, int i);
+        void add(UrgData const& data, int i);
+        void finish();
+        void mergeWrapped(UrgData const& data);
+        
+        float lambda;
+        float sigma;
+        int min_points;
+        int max_gap;
+        
+        // sin(dphi) / sin(lambda - dphi) for beams 0 to max_gap + 1 steps
+        // apart, rebuilt when the angle table changes
+        vector<float> ratios;
+        AngleTablePtr ratio_table;
+        
+        vector<Cluster> clusters;
+        Cluster current;
+        ofVec2f sum;
+    };
+
+}
+
+#endif /* defined(__example_ofxUrgDevice__ScanSegmenter__) */
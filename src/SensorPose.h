@@ -0,0 +1,25 @@
+//
+//  SensorPose.h
+//  example_ofxUrgDevice
+//
+//
+
+#ifndef __example_ofxUrgDevice__SensorPose__
+#define __example_ofxUrgDevice__SensorPose__
+
+namespace ofxUrg {
+
+    // placement of a sensor in the world [mm], [degree].
+    // angle is the same as ofxUrgDevice::setSensorAngle().
+    struct SensorPose
+    {
+        float x;
+        float y;
+        float angle;
+        
+        SensorPose(float _x = 0, float _y = 0, float _angle = 0) : x(_x), y(_y), angle(_angle) {}
+    };
+
+}
+
+#endif /* defined(__example_ofxUrgDevice__SensorPose__) */
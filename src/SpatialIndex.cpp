@@ -0,0 +1,254 @@
+//
+//  SpatialIndex.cpp
+//  example_ofxUrgDevice
+//
+//
+
+#include "SpatialIndex.h"
+
+using namespace ofxUrg;
+
+SpatialIndex::SpatialIndex()
+:origin_x(0), origin_y(0), width(0), height(0)
+{
+    setup();
+    cell_begin.assign(1, 0);
+}
+
+void SpatialIndex::setup(float cell_size_)
+{
+    cell_size = max(cell_size_, 1.0f);
+    used_cell_size = cell_size;
+    inverse_cell = 1.0 / cell_size;
+}
+
+void SpatialIndex::build(vector<ofVec2f> const& points)
+{
+    begin(points.size());
+    for (int i=0; i<points.size(); i++) {
+        add(points[i].x, points[i].y, i);
+    }
+    finish();
+}
+
+void SpatialIndex::build(UrgData const& data, SensorPose const& pose)
+{
+    // the rotation of the pose is already applied by setSensorAngle()
+    vector<int> const& survivors = data.getValidIndicesRef();
+    vector<float> const& x = data.getXsRef();
+    vector<float> const& y = data.getYsRef();
+    begin(survivors.size());
+    for (int k=0; k<survivors.size(); k++) {
+        int i = survivors[k];
+        add(x[i] + pose.x, y[i] + pose.y, i);
+    }
+    finish();
+}
+
+void SpatialIndex::begin(int n)
+{
+    input_x.clear();
+    input_y.clear();
+    input_id.clear();
+    input_x.reserve(n);
+    input_y.reserve(n);
+    input_id.reserve(n);
+}
+
+void SpatialIndex::add(float x, float y, int id)
+{
+    input_x.push_back(x);
+    input_y.push_back(y);
+    input_id.push_back(id);
+}
+
+void SpatialIndex::finish()
+{
+    int n = input_x.size();
+    if (n == 0) {
+        width = height = 0;
+        cell_begin.assign(1, 0);
+        xs.clear();
+        ys.clear();
+        ids.clear();
+        return;
+    }
+
+    float min_x = *min_element(input_x.begin(), input_x.end());
+    float max_x = *max_element(input_x.begin(), input_x.end());
+    float min_y = *min_element(input_y.begin(), input_y.end());
+    float max_y = *max_element(input_y.begin(), input_y.end());
+
+    // keeps the number of cells in the order of the number of points
+    used_cell_size = cell_size;
+    float limit = max(4.0 * n, 1024.0);
+    float cells = ((max_x - min_x) / used_cell_size + 1) * ((max_y - min_y) / used_cell_size + 1);
+    if (cells > limit) {
+        used_cell_size *= sqrt(cells / limit);
+    }
+    inverse_cell = 1.0 / used_cell_size;
+    origin_x = min_x;
+    origin_y = min_y;
+    width = cellX(max_x) + 1;
+    height = cellY(max_y) + 1;
+
+    // counting sort by cell
+    cell_begin.assign(width * height + 1, 0);
+    input_cell.resize(n);
+    for (int i=0; i<n; i++) {
+        int c = min(cellY(input_y[i]), height - 1) * width + min(cellX(input_x[i]), width - 1);
+        input_cell[i] = c;
+        cell_begin[c + 1]++;
+    }
+    for (int c=0; c<width * height; c++) {
+        cell_begin[c + 1] += cell_begin[c];
+    }
+    xs.resize(n);
+    ys.resize(n);
+    ids.resize(n);
+    for (int i=0; i<n; i++) {
+        // fills each cell from its end, cell_begin ends up at the beginnings
+        int k = --cell_begin[input_cell[i] + 1];
+        xs[k] = input_x[i];
+        ys[k] = input_y[i];
+        ids[k] = input_id[i];
+    }
+    // the counts were moved one cell down, puts them back
+    for (int c=0; c<width * height; c++) {
+        cell_begin[c] = cell_begin[c + 1];
+    }
+    cell_begin[width * height] = n;
+}
+
+int SpatialIndex::findWithin(ofVec2f const& p, float radius, vector<int>& result) const
+{
+    result.clear();
+    if (width == 0) {
+        return 0;
+    }
+    int x0 = max(cellX(p.x - radius), 0);
+    int x1 = min(cellX(p.x + radius), width - 1);
+    int y0 = max(cellY(p.y - radius), 0);
+    int y1 = min(cellY(p.y + radius), height - 1);
+    if (x0 > x1 || y0 > y1) {
+        return 0;
+    }
+    float radius2 = radius * radius;
+    for (int cy=y0; cy<=y1; cy++) {
+        // the cells of a row are contiguous
+        int k0 = cell_begin[cy * width + x0];
+        int k1 = cell_begin[cy * width + x1 + 1];
+        for (int k=k0; k<k1; k++) {
+            float dx = xs[k] - p.x;
+            float dy = ys[k] - p.y;
+            if (dx * dx + dy * dy <= radius2) {
+                result.push_back(ids[k]);
+            }
+        }
+    }
+    return result.size();
+}
+
+int SpatialIndex::findNearest(ofVec2f const& p, float max_distance) const
+{
+    // the same rings as the k nearest, with the best candidate in place of the heap
+    if (width == 0) {
+        return -1;
+    }
+    int cx = cellX(p.x);
+    int cy = cellY(p.y);
+    float best2 = max_distance < FLT_MAX ? max_distance * max_distance : FLT_MAX;
+    int best = -1;
+    int last_ring = max(max(cx, width - 1 - cx), max(cy, height - 1 - cy));
+    for (int ring=0; ring<=last_ring; ring++) {
+        float bound = max(ring - 1, 0) * used_cell_size;
+        if (bound * bound > best2) {
+            break;
+        }
+        int y0 = max(cy - ring, 0);
+        int y1 = min(cy + ring, height - 1);
+        for (int y=y0; y<=y1; y++) {
+            bool edge = y == cy - ring || y == cy + ring;
+            int step = edge ? 1 : max(2 * ring, 1);
+            for (int x=cx - ring; x<=cx + ring; x+=step) {
+                if (x < 0 || x >= width) continue;
+                int c = y * width + x;
+                for (int i=cell_begin[c]; i<cell_begin[c + 1]; i++) {
+                    float dx = xs[i] - p.x;
+                    float dy = ys[i] - p.y;
+                    float d2 = dx * dx + dy * dy;
+                    if (d2 < best2) {
+                        best2 = d2;
+                        best = ids[i];
+                    }
+                }
+            }
+        }
+    }
+    return best;
+}
+
+void SpatialIndex::searchRing(int cx, int cy, int ring, ofVec2f const& p, int k, float max_distance2) const
+{
+    int y0 = max(cy - ring, 0);
+    int y1 = min(cy + ring, height - 1);
+    for (int y=y0; y<=y1; y++) {
+        // the whole row on the top and bottom edges, two cells on the others
+        bool edge = y == cy - ring || y == cy + ring;
+        int step = edge ? 1 : max(2 * ring, 1);
+        for (int x=cx - ring; x<=cx + ring; x+=step) {
+            if (x < 0 || x >= width) continue;
+            int c = y * width + x;
+            for (int i=cell_begin[c]; i<cell_begin[c + 1]; i++) {
+                float dx = xs[i] - p.x;
+                float dy = ys[i] - p.y;
+                Candidate candidate = { dx * dx + dy * dy, ids[i] };
+                if (candidate.distance2 > max_distance2) continue;
+                if (heap.size() < k) {
+                    heap.push_back(candidate);
+                    push_heap(heap.begin(), heap.end());
+                } else if (candidate < heap.front()) {
+                    pop_heap(heap.begin(), heap.end());
+                    heap.back() = candidate;
+                    push_heap(heap.begin(), heap.end());
+                }
+            }
+        }
+    }
+}
+
+int SpatialIndex::findNearest(ofVec2f const& p, int k, vector<int>& result, float max_distance) const
+{
+    result.clear();
+    if (width == 0 || k <= 0) {
+        return 0;
+    }
+    int cx = cellX(p.x);
+    int cy = cellY(p.y);
+    float max_distance2 = max_distance < FLT_MAX ? max_distance * max_distance : FLT_MAX;
+
+    // rings of cells around the cell of p, until the nearest point of the
+    // next ring cannot beat the k-th candidate
+    heap.clear();
+    int last_ring = max(max(cx, width - 1 - cx), max(cy, height - 1 - cy));
+    for (int ring=0; ring<=last_ring; ring++) {
+        float bound = max(ring - 1, 0) * used_cell_size;
+        if (bound * bound > max_distance2) {
+            break;
+        }
+        if (heap.size() == k && bound * bound > heap.front().distance2) {
+            break;
+        }
+        if (cx + ring < 0 || cx - ring >= width || cy + ring < 0 || cy - ring >= height) {
+            // p is out of the grid, the ring has not reached it yet
+            continue;
+        }
+        searchRing(cx, cy, ring, p, k, max_distance2);
+    }
+
+    sort_heap(heap.begin(), heap.end());
+    for (int i=0; i<heap.size(); i++) {
+        result.push_back(heap[i].id);
+    }
+    return result.size();
+}
@@ -0,0 +1,85 @@
+//
+//  SpatialIndex.h
+//  example_ofxUrgDevice
+//
+//
+
+#ifndef __example_ofxUrgDevice__SpatialIndex__
+#define __example_ofxUrgDevice__SpatialIndex__
+
+#include "ofMain.h"
+#include "UrgData.h"
+#include "SensorPose.h"
+#include <cfloat>
+
+namespace ofxUrg {
+
+    // uniform grid over the points of a frame for radius and nearest
+    // neighbour queries. build() counting-sorts the points by cell in O(n)
+    // into flat arrays, so the points of a cell are contiguous, and reuses
+    // the arrays of the previous frame.
+    // queries return ids: the position in the vector given to build(), or
+    // the beam index for a scan.
+    class SpatialIndex
+    {
+    public:
+        SpatialIndex();
+
+        // cell_size: about the usual query radius [mm]. larger cells are used
+        // when the points spread so far that the cells would outnumber them.
+        void setup(float cell_size = 300);
+
+        // e.g. ofxUrgManager::getPointsRef() for every sensor
+        void build(vector<ofVec2f> const& points);
+        // the valid beams, placed the same way as ofxUrgManager
+        void build(UrgData const& data, SensorPose const& pose = SensorPose());
+
+        int size() const { return xs.size(); }
+
+        // ids of the points within the radius, in no particular order.
+        // result is cleared first. returns the number of points.
+        int findWithin(ofVec2f const& p, float radius, vector<int>& result) const;
+        // id of the nearest point within max_distance, or -1
+        int findNearest(ofVec2f const& p, float max_distance = FLT_MAX) const;
+        // ids of the k nearest points within max_distance, nearest first
+        int findNearest(ofVec2f const& p, int k, vector<int>& result, float max_distance = FLT_MAX) const;
+
+    private:
+        struct Candidate
+        {
+            float distance2;
+            int id;
+            bool operator<(Candidate const& rhs) const { return distance2 < rhs.distance2; }
+        };
+
+        void begin(int n);
+        void add(float x, float y, int id);
+        void finish();
+        int cellX(float x) const { return floor((x - origin_x) * inverse_cell); }
+        int cellY(float y) const { return floor((y - origin_y) * inverse_cell); }
+        // keeps the k nearest in the heap, from the cells at the Chebyshev
+        // distance ring from (cx, cy)
+        void searchRing(int cx, int cy, int ring, ofVec2f const& p, int k, float max_distance2) const;
+
+        float cell_size;
+        float used_cell_size;
+        float inverse_cell;
+        float origin_x, origin_y;
+        int width, height;
+
+        // input order while building
+        vector<float> input_x, input_y;
+        vector<int> input_id;
+        vector<int> input_cell;
+        // sorted by cell
+        vector<int> cell_begin;     // width * height + 1
+        vector<float> xs, ys;
+        vector<int> ids;
+
+        // query work area, so queries are not thread safe
+        mutable vector<Candidate> heap;
+    };
+
+}
+
+#endif /* defined(__example_ofxUrgDevice__SpatialIndex__) */
@@ -0,0 +1,127 @@
+//
+//  TemporalFilter.cpp
+//  example_ofxUrgDevice
+//
+//
+
+#include "TemporalFilter.h"
+#include <algorithm>
+#include <cstdlib>
+
+using namespace ofxUrg;
+using namespace std;
+
+TemporalFilter::TemporalFilter()
+: num_beams(0), filled(0), head(0)
+{
+    setup(None);
+}
+
+void TemporalFilter::setup(Mode mode_, int window_, float alpha_, long hysteresis_, long jump_)
+{
+    mode = mode_;
+    window = min(max(window_, 1), static_cast<int>(MaxWindow)) | 1;
+    alpha = min(max(alpha_, 0.0f), 1.0f);
+    hysteresis = max(hysteresis_, 0L);
+    jump = max(jump_, 0L);
+    reset();
+}
+
+void TemporalFilter::reset()
+{
+    num_beams = 0;
+    filled = 0;
+    head = 0;
+}
+
+void TemporalFilter::apply(vector<long>& ranges, long min_distance)
+{
+    if (ranges.size() != num_beams) {
+        // the capture range changed
+        num_beams = ranges.size();
+        filled = 0;
+        head = 0;
+        if (mode == Median) {
+            history.resize(num_beams * window);
+            sorted.resize(num_beams * window);
+        } else if (mode == Exponential) {
+            average.assign(num_beams, -1.0f);
+            held.assign(num_beams, 0);
+        }
+    }
+
+    if (mode == Median) {
+        applyMedian(ranges, min_distance);
+    } else if (mode == Exponential) {
+        applyExponential(ranges, min_distance);
+    }
+}
+
+void TemporalFilter::applyMedian(vector<long>& ranges, long min_distance)
+{
+    bool full = filled == window;
+    int slot = full ? head : filled;
+    int count = full ? window : filled + 1;
+
+    for (int b=0; b<num_beams; b++) {
+        long* raw = &history[b * window];
+        long* s = &sorted[b * window];
+        long x = ranges[b];
+
+        // drops the oldest range, then inserts the new one
+        int n = filled;
+        if (full) {
+            long oldest = raw[slot];
+            int i = lower_bound(s, s + n, oldest) - s;
+            copy(s + i + 1, s + n, s + i);
+            n--;
+        }
+        int i = n;
+        while (i > 0 && s[i - 1] > x) {
+            s[i] = s[i - 1];
+            i--;
+        }
+        s[i] = x;
+        raw[slot] = x;
+
+        // error codes sort first. the median of the valid ranges replaces
+        // the scan while they are the majority of the window.
+        int invalid = 0;
+        while (invalid < count && s[invalid] < min_distance) {
+            invalid++;
+        }
+        int valid = count - invalid;
+        if (valid * 2 > count) {
+            ranges[b] = s[invalid + (valid - 1) / 2];
+        }
+    }
+
+    if (full) {
+        head = (head + 1) % window;
+    } else {
+        filled++;
+    }
+}
+
+void TemporalFilter::applyExponential(vector<long>& ranges, long min_distance)
+{
+    for (int b=0; b<num_beams; b++) {
+        long x = ranges[b];
+        float& a = average[b];
+        if (x < min_distance) {
+            a = -1.0f;
+            continue;
+        }
+        if (a < 0 || labs(x - static_cast<long>(a)) > jump) {
+            a = x;
+            held[b] = x;
+        } else {
+            a += alpha * (x - a);
+            long y = static_cast<long>(a + 0.5f);
+            if (labs(y - held[b]) >= hysteresis) {
+                held[b] = y;
+            }
+        }
+        ranges[b] = held[b];
+    }
+}
@@ -0,0 +1,65 @@
+//
+//  TemporalFilter.h
+//  example_ofxUrgDevice
+//
+//
+
+#ifndef __example_ofxUrgDevice__TemporalFilter__
+#define __example_ofxUrgDevice__TemporalFilter__
+
+#include <vector>
+
+using std::vector;
+
+namespace ofxUrg {
+
+    // smooths each beam over the last scans, before UrgData is built.
+    // the history is stored beam-major: the window of a beam is contiguous,
+    // and kept sorted, so a new scan costs one insertion per beam.
+    class TemporalFilter
+    {
+    public:
+        enum Mode {
+            None,
+            Median,         // median of the last window scans
+            Exponential     // exponential moving average with hysteresis
+        };
+        enum { MaxWindow = 15 };
+
+        TemporalFilter();
+
+        // window: scans of the median, made odd. a moving edge lags by window / 2 scans.
+        // alpha: weight of a new scan in the average.
+        // hysteresis: smaller changes keep the previous output [mm].
+        // jump: larger changes restart the average, so edges do not smear [mm].
+        void setup(Mode mode = Median, int window = 3, float alpha = 0.5, long hysteresis = 0, long jump = 100);
+        Mode getMode() const { return mode; }
+
+        // filters the ranges in place. values below min_distance are error
+        // codes of the sensor, they are left out of the window.
+        void apply(vector<long>& ranges, long min_distance);
+        // forgets the history, e.g. when the sensor is reconnected
+        void reset();
+
+    private:
+        void applyMedian(vector<long>& ranges, long min_distance);
+        void applyExponential(vector<long>& ranges, long min_distance);
+
+        Mode mode;
+        int window;
+        float alpha;
+        long hysteresis;
+        long jump;
+
+        int num_beams;
+        int filled;             // scans in the window
+        int head;               // slot of the oldest scan
+        vector<long> history;   // num_beams * window, in arrival order from head
+        vector<long> sorted;    // num_beams * window, the first filled values sorted
+        vector<float> average;  // negative: restarts from the next valid range
+        vector<long> held;      // last output of the average
+    };
+
+}
+
+#endif /* defined(__example_ofxUrgDevice__TemporalFilter__) */
@@ -0,0 +1,320 @@
+//
+//  Tracker.cpp
+//  example_ofxUrgDevice
+//
+//
+
+#include "Tracker.h"
+#include <limits>
+
+using namespace ofxUrg;
+
+Tracker::Tracker()
+: association(Greedy)
+,gate(9.21)
+,merge_distance(150)
+,next_id(0)
+,last_timestamp(-1)
+{
+    setup();
+    setNoise();
+}
+
+void Tracker::setup(int max_tracks, int confirm_hits_, int max_misses_)
+{
+    confirm_hits = max(confirm_hits_, 1);
+    max_misses = max(max_misses_, 0);
+
+    max_tracks = max(max_tracks, 1);
+    pool.assign(max_tracks, Slot());
+    live.clear();
+    live.reserve(max_tracks);
+    tracks.clear();
+    tracks.reserve(max_tracks);
+    measurements.clear();
+    measurements.reserve(max_tracks * 2);
+    for (int i=0; i<pool.size(); i++) {
+        pool[i].alive = false;
+    }
+    last_timestamp = -1;
+}
+
+void Tracker::setNoise(float sigma, float acceleration, float speed)
+{
+    r = sigma * sigma;
+    q = acceleration * acceleration;
+    v0 = speed * speed;
+}
+
+void Tracker::clear()
+{
+    for (int i=0; i<pool.size(); i++) {
+        pool[i].alive = false;
+    }
+    live.clear();
+    tracks.clear();
+    measurements.clear();
+    last_timestamp = -1;
+}
+
+void Tracker::addMeasurement(ofVec2f const& p, int source)
+{
+    // the same object seen by another sensor
+    float d2 = merge_distance * merge_distance;
+    for (int i=0; i<measurements.size(); i++) {
+        Measurement& m = measurements[i];
+        if (m.source != source && (m.position - p).squareLength() < d2) {
+            m.position = (m.position * m.weight + p) / (m.weight + 1);
+            m.weight += 1;
+            return;
+        }
+    }
+
+    Measurement m;
+    m.position = p;
+    m.weight = 1;
+    m.source = source;
+    measurements.push_back(m);
+}
+
+void Tracker::addClusters(vector<Cluster> const& clusters, SensorPose const& pose, int source)
+{
+    // the rotation of the pose is already applied by setSensorAngle()
+    for (int i=0; i<clusters.size(); i++) {
+        addMeasurement(clusters[i].centroid + ofVec2f(pose.x, pose.y), source);
+    }
+}
+
+void Tracker::update(long timestamp)
+{
+    float dt = 0;
+    if (last_timestamp >= 0 && timestamp > last_timestamp) {
+        dt = (timestamp - last_timestamp) / 1000.0;
+    }
+    last_timestamp = timestamp;
+
+    predict(dt);
+    associate();
+
+    int n = live.size();
+    for (int k=0; k<n; k++) {
+        Slot& slot = pool[live[k]];
+        Track& t = slot.track;
+        t.age++;
+        if (assignment[k] >= 0) {
+            correct(slot, measurements[assignment[k]].position);
+            t.hits++;
+            t.misses = 0;
+            t.confirmed = t.confirmed || t.hits >= confirm_hits;
+        } else {
+            t.misses++;
+            if (!t.confirmed || t.misses > max_misses) {
+                slot.alive = false;
+            }
+        }
+    }
+
+    for (int j=0; j<measurements.size(); j++) {
+        if (!taken[j]) {
+            spawn(measurements[j].position);
+        }
+    }
+    measurements.clear();
+
+    live.clear();
+    tracks.clear();
+    for (int i=0; i<pool.size(); i++) {
+        if (pool[i].alive) {
+            live.push_back(i);
+            tracks.push_back(pool[i].track);
+        }
+    }
+}
+
+void Tracker::predict(float dt)
+{
+    float dt2 = dt * dt;
+    float q00 = q * dt2 * dt2 / 4;
+    float q01 = q * dt2 * dt / 2;
+    float q11 = q * dt2;
+    for (int k=0; k<live.size(); k++) {
+        Slot& s = pool[live[k]];
+        s.track.position += s.track.velocity * dt;
+        s.p00 += 2 * dt * s.p01 + dt2 * s.p11 + q00;
+        s.p01 += dt * s.p11 + q01;
+        s.p11 += q11;
+    }
+}
+
+float Tracker::cost(Slot const& slot, ofVec2f const& z) const
+{
+    // squared Mahalanobis distance of the innovation
+    return (z - slot.track.position).squareLength() / (slot.p00 + r);
+}
+
+void Tracker::associate()
+{
+    int n = live.size();
+    int m = measurements.size();
+    assignment.assign(n, -1);
+    taken.assign(m, false);
+    if (n == 0 || m == 0) {
+        return;
+    }
+
+    costs.resize(n * m);
+    for (int k=0; k<n; k++) {
+        Slot const& slot = pool[live[k]];
+        for (int j=0; j<m; j++) {
+            costs[k * m + j] = cost(slot, measurements[j].position);
+        }
+    }
+
+    if (association == Hungarian) {
+        associateHungarian();
+    } else {
+        associateGreedy();
+    }
+}
+
+void Tracker::associateGreedy()
+{
+    int n = live.size();
+    int m = measurements.size();
+    pairs.clear();
+    for (int k=0; k<n; k++) {
+        for (int j=0; j<m; j++) {
+            float c = costs[k * m + j];
+            if (c < gate) {
+                Pair pair = { c, k, j };
+                pairs.push_back(pair);
+            }
+        }
+    }
+    sort(pairs.begin(), pairs.end());
+
+    for (int i=0; i<pairs.size(); i++) {
+        Pair const& pair = pairs[i];
+        if (assignment[pair.slot] < 0 && !taken[pair.measurement]) {
+            assignment[pair.slot] = pair.measurement;
+            taken[pair.measurement] = true;
+        }
+    }
+}
+
+// the O(n^3) shortest augmenting path method on a square matrix.
+// pairs outside the gate, and the padding, cost the gate itself: the same
+// as leaving both unassigned, so the result is the optimal gated assignment.
+void Tracker::associateHungarian()
+{
+    int rows = live.size();
+    int cols = measurements.size();
+    int n = max(rows, cols);
+    const double inf = numeric_limits<double>::max();
+
+    u.assign(n + 1, 0);
+    v.assign(n + 1, 0);
+    p.assign(n + 1, 0);
+    way.assign(n + 1, 0);
+
+    for (int i=1; i<=n; i++) {
+        p[0] = i;
+        int j0 = 0;
+        minv.assign(n + 1, inf);
+        used.assign(n + 1, false);
+        do {
+            used[j0] = true;
+            int i0 = p[j0];
+            int j1 = 0;
+            double delta = inf;
+            for (int j=1; j<=n; j++) {
+                if (used[j]) continue;
+                double c = gate;
+                if (i0 <= rows && j <= cols) {
+                    c = min(costs[(i0 - 1) * cols + (j - 1)], gate);
+                }
+                double cur = c - u[i0] - v[j];
+                if (cur < minv[j]) {
+                    minv[j] = cur;
+                    way[j] = j0;
+                }
+                if (minv[j] < delta) {
+                    delta = minv[j];
+                    j1 = j;
+                }
+            }
+            for (int j=0; j<=n; j++) {
+                if (used[j]) {
+                    u[p[j]] += delta;
+                    v[j] -= delta;
+                } else {
+                    minv[j] -= delta;
+                }
+            }
+            j0 = j1;
+        } while (p[j0] != 0);
+        do {
+            int j1 = way[j0];
+            p[j0] = p[j1];
+            j0 = j1;
+        } while (j0);
+    }
+
+    for (int j=1; j<=cols; j++) {
+        int i = p[j];
+        if (i >= 1 && i <= rows && costs[(i - 1) * cols + (j - 1)] < gate) {
+            assignment[i - 1] = j - 1;
+            taken[j - 1] = true;
+        }
+    }
+}
+
+void Tracker::correct(Slot& s, ofVec2f const& z)
+{
+    float S = s.p00 + r;
+    float k0 = s.p00 / S;
+    float k1 = s.p01 / S;
+    ofVec2f innovation = z - s.track.position;
+    s.track.position += innovation * k0;
+    s.track.velocity += innovation * k1;
+    s.p11 -= k1 * s.p01;
+    s.p01 *= 1 - k0;
+    s.p00 *= 1 - k0;
+}
+
+void Tracker::spawn(ofVec2f const& z)
+{
+    for (int i=0; i<pool.size(); i++) {
+        Slot& s = pool[i];
+        if (s.alive) continue;
+
+        s.alive = true;
+        s.track.id = next_id++;
+        s.track.position = z;
+        s.track.velocity = ofVec2f();
+        s.track.age = 0;
+        s.track.hits = 1;
+        s.track.misses = 0;
+        s.track.confirmed = confirm_hits <= 1;
+        s.p00 = r;
+        s.p01 = 0;
+        s.p11 = v0;
+        return;
+    }
+}
+
+void Tracker::draw() const
+{
+    ofPushStyle();
+    ofNoFill();
+    for (int i=0; i<tracks.size(); i++) {
+        Track const& t = tracks[i];
+        ofSetColor(ofColor::fromHsb((t.id*40) % 256, 255, 255, t.confirmed ? 255 : 100));
+        ofCircle(t.position.x, t.position.y, 200);
+        // where the track will be in 0.5 [sec]
+        ofLine(t.position.x, t.position.y,
+               t.position.x + t.velocity.x * 0.5, t.position.y + t.velocity.y * 0.5);
+        ofDrawBitmapString(ofToString(t.id), t.position.x + 200, t.position.y);
+    }
+    ofPopStyle();
+}
@@ -0,0 +1,131 @@
+//
+//  Tracker.h
+//  example_ofxUrgDevice
+//
+//
+
+#ifndef __example_ofxUrgDevice__Tracker__
+#define __example_ofxUrgDevice__Tracker__
+
+#include "ofMain.h"
+#include "ScanSegmenter.h"
+#include "SensorPose.h"
+
+namespace ofxUrg {
+
+    struct Track
+    {
+        int id;             // unique while the tracker lives, never reused
+        ofVec2f position;   // [mm]
+        ofVec2f velocity;   // [mm/s]
+        int age;            // number of updates since the birth
+        int hits;           // number of updates with a measurement
+        int misses;         // consecutive updates without a measurement
+        bool confirmed;     // seen in confirm_hits updates
+    };
+
+    // follows objects over frames with a constant velocity Kalman filter
+    // per track. measurements (cluster centroids) are associated to the
+    // predicted tracks inside a chi-square gate, either greedily by the
+    // smallest Mahalanobis distance or globally optimal (Hungarian).
+    // tracks live in a pool allocated by setup(), so an update allocates nothing.
+    class Tracker
+    {
+    public:
+        enum Association {
+            Greedy,
+            Hungarian
+        };
+
+        Tracker();
+
+        // max_tracks: size of the pool, measurements beyond it are ignored.
+        // confirm_hits: hits to become confirmed, max_misses: misses to be deleted.
+        // unconfirmed tracks are deleted by the first miss.
+        void setup(int max_tracks = 128, int confirm_hits = 3, int max_misses = 10);
+        // sigma: measurement noise [mm], acceleration: process noise [mm/s^2],
+        // speed: initial velocity uncertainty [mm/s]
+        void setNoise(float sigma = 50, float acceleration = 2000, float speed = 2000);
+        // squared Mahalanobis distance of the gate. 9.21 keeps 99% of the
+        // true measurements with 2 degrees of freedom.
+        void setGate(float chi2 = 9.21) { gate = chi2; }
+        void setAssociation(Association a) { association = a; }
+        // measurements of different sensors closer than this are averaged,
+        // so an object seen by two sensors makes one track [mm]
+        void setMergeDistance(float mm) { merge_distance = mm; }
+
+        // measurements of the next update(), in world coordinates [mm]
+        void addMeasurement(ofVec2f const& p, int source = 0);
+        // the pose moves the centroids the same way as ofxUrgManager
+        void addClusters(vector<Cluster> const& clusters, SensorPose const& pose = SensorPose(), int source = 0);
+
+        // predicts the tracks to the timestamp [msec] (UrgData::getTimestamp()),
+        // and corrects them with the measurements added since the last update
+        void update(long timestamp);
+        void clear();
+
+        // live tracks, in the order of the pool
+        vector<Track> const& getTracksRef() const { return tracks; }
+
+        void draw() const;
+
+    private:
+        // x and y share the same model and noise, so both axes have the same
+        // covariance of (position, velocity)
+        struct Slot
+        {
+            Track track;
+            bool alive;
+            float p00, p01, p11;
+        };
+        struct Measurement
+        {
+            ofVec2f position;
+            float weight;
+            int source;
+        };
+
+        void predict(float dt);
+        void associate();
+        void associateGreedy();
+        void associateHungarian();
+        void correct(Slot& slot, ofVec2f const& z);
+        void spawn(ofVec2f const& z);
+        float cost(Slot const& slot, ofVec2f const& z) const;
+
+        Association association;
+        int confirm_hits;
+        int max_misses;
+        float r;        // measurement variance
+        float q;        // acceleration variance
+        float v0;       // initial velocity variance
+        float gate;
+        float merge_distance;
+
+        vector<Slot> pool;
+        vector<int> live;
+        vector<Measurement> measurements;
+        vector<Track> tracks;
+        int next_id;
+        long last_timestamp;
+
+        // association work area, reused between updates
+        vector<float> costs;        // live.size() * measurements.size()
+        vector<int> assignment;     // measurement of each live slot, or -1
+        vector<bool> taken;
+        struct Pair
+        {
+            float cost;
+            int slot;
+            int measurement;
+            bool operator<(Pair const& rhs) const { return cost < rhs.cost; }
+        };
+        vector<Pair> pairs;
+        vector<double> u, v, minv;
+        vector<int> p, way;
+        vector<bool> used;
+    };
+
+}
+
+#endif /* defined(__example_ofxUrgDevice__Tracker__) */
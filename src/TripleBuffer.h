@@ -0,0 +1,60 @@
+//
+//  TripleBuffer.h
+//  example_ofxUrgDevice
+//
+//
+
+#ifndef __example_ofxUrgDevice__TripleBuffer__
+#define __example_ofxUrgDevice__TripleBuffer__
+
+#include "Lock.h"
+#include "LockGuard.h"
+#include <algorithm>
+
+namespace ofxUrg {
+
+    // single writer / single reader hand-off without copying the value.
+    // the writer fills back() and publish()es it, the reader calls update()
+    // and reads front(). only the slot indices are swapped under the lock,
+    // so neither side waits for the other to finish with its slot.
+    template <class T>
+    class TripleBuffer
+    {
+    public:
+        TripleBuffer() : back_index(0), middle_index(1), front_index(2), fresh(false) {}
+        
+        // writer side
+        T& back() { return slots[back_index]; }
+        void publish()
+        {
+            qrk::LockGuard guard(mutex);
+            std::swap(back_index, middle_index);
+            fresh = true;
+        }
+        
+        // reader side. returns true when front() was replaced by a new value.
+        bool update()
+        {
+            qrk::LockGuard guard(mutex);
+            if (!fresh) {
+                return false;
+            }
+            std::swap(front_index, middle_index);
+            fresh = false;
+            return true;
+        }
+        T& front() { return slots[front_index]; }
+        T const& front() const { return slots[front_index]; }
+        
+    private:
+        T slots[3];
+        int back_index;
+        int middle_index;
+        int front_index;
+        bool fresh;
+        qrk::Lock mutex;
+    };
+
+}
+
+#endif /* defined(__example_ofxUrgDevice__TripleBuffer__) */
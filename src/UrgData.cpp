@@ -10,9 +10,86 @@
 
 using namespace ofxUrg;
 
+void UrgData::updateCartesian() const
+{
+    if (cartesian_updated) {
+        return;
+    }
+    
+    int n = max(size(), 0);
+    xs.resize(n);
+    ys.resize(n);
+    
+    // plain loops over contiguous arrays, so that the compiler can vectorize them
+    long const* d = n ? &data[0] : NULL;
+    float const* c = n ? &getCosRef()[0] : NULL;
+    float const* s = n ? &getSinRef()[0] : NULL;
+    float* x = n ? &xs[0] : NULL;
+    float* y = n ? &ys[0] : NULL;
+    for (int i=0; i<n; i++) {
+        x[i] = d[i] * c[i];
+    }
+    for (int i=0; i<n; i++) {
+        y[i] = - d[i] * s[i];
+    }
+    
+    valid_indices.clear();
+    for (int i=valid.next(0); i>=0 && i<n; i=valid.next(i+1)) {
+        valid_indices.push_back(i);
+    }
+    if (valid.size() < n) {
+        // beams without a mask are valid
+        for (int i=valid.size(); i<n; i++) valid_indices.push_back(i);
+    }
+    
+    // retroreflectors, one mask word at a time
+    reflectors.resize(n);
+    if (hasIntensity() && n) {
+        long const* v = &intensity[0];
+        vector<BeamMask::Word>& words = reflectors.getWordsRef();
+        vector<BeamMask::Word> const& valid_words = valid.getWordsRef();
+        for (int w=0; w<words.size(); w++) {
+            int first = w * BeamMask::WordBits;
+            int last = min(first + (int)BeamMask::WordBits, n);
+            BeamMask::Word bits = 0;
+            for (int i=first; i<last; i++) {
+                bits |= BeamMask::Word(v[i] >= reflector_threshold) << (i - first);
+            }
+            words[w] = w < valid_words.size() ? bits & valid_words[w] : bits;
+        }
+    }
+    cartesian_updated = true;
+}
+
+void UrgData::applyGate(long near_distance, long far_distance, int first_index, int last_index)
+{
+    int n = data.size();
+    if (valid.size() != n) {
+        valid.resize(n, true);
+    }
+    first_index = max(first_index, 0);
+    last_index = min(last_index, n - 1);
+    
+    // branch free, one mask word at a time
+    long const* d = n ? &data[0] : NULL;
+    vector<BeamMask::Word>& words = valid.getWordsRef();
+    for (int w=0; w<words.size(); w++) {
+        int first = w * BeamMask::WordBits;
+        int last = min(first + (int)BeamMask::WordBits, n);
+        BeamMask::Word bits = 0;
+        for (int i=first; i<last; i++) {
+            bool inside = (d[i] >= near_distance) & (d[i] <= far_distance)
+                        & (i >= first_index) & (i <= last_index);
+            bits |= BeamMask::Word(inside) << (i - first);
+        }
+        words[w] &= bits;
+    }
+    cartesian_updated = false;
+}
+
 void UrgData::draw(float x, float y) const
 {
-    if (data.size() != data_angles.size()) {
+    if (size() < 0) {
         return;
     }
     
@@ -21,9 +98,10 @@ void UrgData::draw(float x, float y) const
     ofNoFill();
     ofTranslate(x, y);
     
-    float offset = ofDegToRad(sensor_angle + 90);
-    for (int i=0; i<data.size(); i++) {
-        ofLine(0, 0, data[i]*cos(data_angles[i]+offset), - data[i]*sin(data_angles[i]+offset));
+    updateCartesian();
+    for (int k=0; k<valid_indices.size(); k++) {
+        int i = valid_indices[k];
+        ofLine(0, 0, xs[i], ys[i]);
     }
     
     ofPopMatrix();
@@ -34,7 +112,7 @@ void UrgData::draw(float x, float y) const
 
 void UrgData::drawShape(float x, float y) const
 {
-    if (data.size() != data_angles.size()) {
+    if (size() < 0) {
         return;
     }
     
@@ -44,11 +122,12 @@ void UrgData::drawShape(float x, float y) const
     ofSetLineWidth(2);
     ofTranslate(x, y);
     
-    float offset = ofDegToRad(sensor_angle + 90);
+    updateCartesian();
     ofPolyline line;
     line.addVertex(0,0);
-    for (int i=0; i<data.size(); i++) {
-        line.addVertex(data[i]*cos(data_angles[i]+offset), -data[i]*sin(data_angles[i]+offset));
+    for (int k=0; k<valid_indices.size(); k++) {
+        int i = valid_indices[k];
+        line.addVertex(xs[i], ys[i]);
     }
     line.close();
     
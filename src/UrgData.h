@@ -10,50 +10,162 @@
 #define __example_ofxUrgDevice__UrgData__
 
 #include "ofMain.h"
+#include "BeamMask.h"
+#include "AngleTable.h"
+#include <climits>
 
 namespace ofxUrg {
 
     class UrgData
     {
     public:
-        UrgData() {}
+        UrgData() : angle_table(new AngleTable), timestamp(0), reflector_threshold(LONG_MAX), cartesian_updated(false) {}
         UrgData(vector<long> const& _data, vector<float> const& _angles)
-        :data(_data), data_angles(_angles)
+        :data(_data), angle_table(new AngleTable(_angles, 0)), valid(_data.size(), true)
+        ,timestamp(0), reflector_threshold(LONG_MAX), cartesian_updated(false)
         {}
         
         UrgData(vector<long> const& _data, vector<float> const& _angles, float _sensor_angle)
-        :data(_data), data_angles(_angles), sensor_angle(_sensor_angle)
+        :data(_data), angle_table(new AngleTable(_angles, _sensor_angle)), valid(_data.size(), true)
+        ,timestamp(0), reflector_threshold(LONG_MAX), cartesian_updated(false)
         {}
         
-        int size() const { return data.size()==data_angles.size() ? data.size() : -1; }
+        int size() const { return data.size()==angle_table->size() ? data.size() : -1; }
         void resize(int size)
         {
             data.resize(size);
-            data_angles.resize(size);
+            if (!intensity.empty()) intensity.resize(size);
+            mutableAngleTable().resize(size);
+            valid.resize(size, true);
+            cartesian_updated = false;
         }
         
-        void clear() { data.clear(); data_angles.clear(); }
-        void setData(vector<long> const& _data) { data = _data; }
-        void setDataAngles(vector<float> const& _angles) { data_angles = _angles; }
-        void setSensorAngle(float angle) { sensor_angle = angle; }
+        void clear()
+        {
+            data.clear();
+            intensity.clear();
+            angle_table.reset(new AngleTable(vector<float>(), getSensorAngle()));
+            valid.clear();
+            cartesian_updated = false;
+        }
+        // every beam is valid until setValidMask() is called
+        void setData(vector<long> const& _data)
+        {
+            data = _data;
+            valid.resize(data.size(), true);
+            cartesian_updated = false;
+        }
+        void setDataAngles(vector<float> const& _angles)
+        {
+            angle_table.reset(new AngleTable(_angles, getSensorAngle()));
+            cartesian_updated = false;
+        }
+        // shares the table between frames. it is copied before being modified.
+        void setAngleTable(AngleTablePtr const& table)
+        {
+            if (table != angle_table) cartesian_updated = false;
+            angle_table = table;
+        }
+        void setSensorAngle(float angle)
+        {
+            if (angle == getSensorAngle()) return;
+            mutableAngleTable().setSensorAngle(angle);
+            cartesian_updated = false;
+        }
+        void setValidMask(BeamMask const& mask) { valid = mask; cartesian_updated = false; }
+        // marks the beams set in the mask invalid
+        void invalidate(BeamMask const& beams) { valid.subtract(beams); cartesian_updated = false; }
+        // intensity of each beam, parallel to the range data. empty unless IntensityCapture.
+        void setIntensity(vector<long> const& _intensity) { intensity = _intensity; cartesian_updated = false; }
+        // beams at or above the threshold are marked as retroreflectors
+        void setReflectorThreshold(long threshold)
+        {
+            if (threshold != reflector_threshold) cartesian_updated = false;
+            reflector_threshold = threshold;
+        }
+        // host time when the scan was received [msec]
+        void setTimestamp(long _timestamp) { timestamp = _timestamp; }
+        
+        // marks beams out of [min_distance, max_distance] invalid.
+        // sensor error codes and lost lines are below min_distance.
+        void updateValidMask(long min_distance, long max_distance)
+        {
+            cartesian_updated = false;
+            valid.resize(data.size());
+            for (int i=0; i<data.size(); i++) {
+                if (min_distance <= data[i] && data[i] <= max_distance) {
+                    valid.set(i);
+                }
+            }
+        }
         
-        void addData(long _data) { data.push_back(_data); }
-        void addAngle(float _angle) { data_angles.push_back(_angle); }
+        void addData(long _data) { data.push_back(_data); cartesian_updated = false; }
+        void addAngle(float _angle) { mutableAngleTable().addAngle(_angle); cartesian_updated = false; }
         
-        vector<long>& getDataRef() { return data; }
+        // the caller may modify the data, so the cartesian cache is dropped
+        vector<long>& getDataRef() { cartesian_updated = false; return data; }
         vector<long> const& getDataRef() const { return data; }
-        vector<float>& getDataAnglesRef() { return data_angles; }
-        vector<float> const& getDataAnglesRef() const { return data_angles; }
-        float getSensorAngle() const { return sensor_angle; }
+        vector<long>& getIntensityRef() { cartesian_updated = false; return intensity; }
+        vector<long> const& getIntensityRef() const { return intensity; }
+        bool hasIntensity() const { return !data.empty() && intensity.size() == data.size(); }
+        long getReflectorThreshold() const { return reflector_threshold; }
+        vector<float> const& getDataAnglesRef() const { return angle_table->getAnglesRef(); }
+        // cos/sin of the angles rotated by (sensor angle + 90) degree
+        vector<float> const& getCosRef() const { return angle_table->getCosRef(); }
+        vector<float> const& getSinRef() const { return angle_table->getSinRef(); }
+        AngleTablePtr const& getAngleTable() const { return angle_table; }
+        float getSensorAngle() const { return angle_table->getSensorAngle(); }
+        
+        // screen coordinates of each beam [mm], the same as draw().
+        // computed on the first call after the data or the sensor angle changes.
+        // not thread safe by itself: snapshots of ofxUrgDevice are filled before being shared.
+        vector<float> const& getXsRef() const { updateCartesian(); return xs; }
+        vector<float> const& getYsRef() const { updateCartesian(); return ys; }
+        ofVec2f getPoint(int i) const { updateCartesian(); return ofVec2f(xs[i], ys[i]); }
+        // valid beams whose intensity is at or above the reflector threshold,
+        // computed with the cartesian view
+        BeamMask const& getReflectorMaskRef() const { updateCartesian(); return reflectors; }
+        BeamMask const& getValidMaskRef() const { return valid; }
+        long getTimestamp() const { return timestamp; }
+        bool isValid(int i) const { return i < valid.size() ? valid.test(i) : true; }
+        // indices of the valid beams in ascending order, computed with the cartesian view
+        vector<int> const& getValidIndicesRef() const { updateCartesian(); return valid_indices; }
+        
+        // also marks invalid the beams out of [near_distance, far_distance]
+        // or out of [first_index, last_index]
+        void applyGate(long near_distance, long far_distance, int first_index, int last_index);
         
         void draw(float x, float y) const;
         void drawShape(float x, float y) const;
         
     private:
+        // copy on write: the table may be shared with other frames
+        AngleTable& mutableAngleTable()
+        {
+            if (!angle_table.unique()) {
+                angle_table.reset(new AngleTable(*angle_table));
+            }
+            return *angle_table;
+        }
+        
+        void updateCartesian() const;
+        
         vector<long> data;
-        vector<float> data_angles;
-        float sensor_angle;
+        vector<long> intensity;
+        AngleTablePtr angle_table;
+        BeamMask valid;
+        long timestamp;
+        long reflector_threshold;
+        
+        mutable vector<float> xs;
+        mutable vector<float> ys;
+        mutable BeamMask reflectors;
+        mutable vector<int> valid_indices;
+        mutable bool cartesian_updated;
     };
+    
+    // immutable scan shared between consumers and threads
+    typedef ofPtr<UrgData const> UrgDataPtr;
 
 }
 
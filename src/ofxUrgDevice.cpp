@@ -1,4 +1,5 @@
 #include "ofxUrgDevice.h"
+#include "TripleBuffer.h"
 
 #include "mUrgDevice.h"
 #include "RangeSensorParameter.h"
@@ -35,35 +36,101 @@ inline float modf( float X, float Y )
 struct ofxUrgDevice::Impl
 {
 private:
+    enum { MaxShortRange = 4095 };  // [mm] largest distance in the 2 byte encoding
+    
+    struct Worker : public ofThread
+    {
+        Impl* impl;
+        Worker(Impl* impl_) : impl(impl_) {}
+        
+        void threadedFunction()
+        {
+            while (isThreadRunning()) {
+                if (!impl->captureThreaded()) {
+                    ofSleepMillis(1);
+                }
+            }
+        }
+    };
+    
     FindComPorts com_finder;
     UrgUsbCom urg_usb;
     UrgDevice urg;
     
+    // urg_mutex guards the settings and the angle table, capture_mutex the
+    // device while it talks to the sensor. the worker never holds both, and
+    // the others lock urg_mutex first.
     Lock urg_mutex;
+    Lock capture_mutex;
+    Lock angle_mutex;
     
     vector<string> devices;
     string device;
-    vector<long> data;
     long timestamp;
     
-    ofxUrg::UrgData urg_data;
+    // latest scan of the non-threaded mode, and the slot filled next
+    ofPtr<ofxUrg::UrgData> urg_data;
+    ofPtr<ofxUrg::UrgData> next_data;
+    ofxUrg::AngleTablePtr angle_table;
     
     bool bNearThresh;
     bool bFarThresh;
     long near_thresh;
     long far_thresh;
+    bool bAngleWindow;
+    float min_angle;    // [degree] in the sensor frame, 0 is the front
+    float max_angle;
+    bool bOutlierFilter;
+    ofxUrg::OutlierFilter outlier_filter;
     
-//    float sensor_angle;
+    float sensor_angle;
+    // the last setSensorAngle(), checked under angle_mutex only
+    float applied_angle;
+    bool angle_applied;
     
-    vector<int> filtered_index;
+    RangeCaptureMode capture_mode;
+    int short_range;    // -1: decided by the model
+    int capture_begin;  // -1: area_min of the model
+    int capture_end;    // -1: area_max of the model
+    int capture_skip_lines;
+    int capture_frame_interval;
+    long reflector_threshold;
+    ofxUrg::TemporalFilter temporal_filter;
+    
+
+    Worker worker;
+    ofxUrg::TripleBuffer<ofPtr<ofxUrg::UrgData> > frames;
+    bool threaded;
+    bool frame_new;
     
 public:
     Impl()
     :bNearThresh(false), bFarThresh(false)
     ,near_thresh(0), far_thresh(4000)
-//    ,sensor_angle(0.0)
+    ,bAngleWindow(false), min_angle(-180), max_angle(180)
+    ,bOutlierFilter(false)
+    ,sensor_angle(0.0), applied_angle(0.0), angle_applied(false)
+    ,capture_mode(AutoCapture), short_range(-1)
+    ,capture_begin(-1), capture_end(-1)
+    ,capture_skip_lines(1), capture_frame_interval(0)
+    ,reflector_threshold(LONG_MAX)
+    ,worker(this), threaded(false), frame_new(false)
     {
         devices = findCom();
+        
+        // unattended installations keep reconnecting until the sensor is back
+        urg.setRetryTimes(UrgDevice::Infinity);
+        // streaming returns each scan once, without a request per update()
+        urg.setCaptureMode(capture_mode);
+        
+        urg_data = ofPtr<ofxUrg::UrgData>(new ofxUrg::UrgData);
+        frames.front() = urg_data;
+    }
+    
+    ~Impl()
+    {
+        setThreaded(false);
+        urg.disconnect();
     }
         
     void setup()
@@ -84,44 +151,275 @@ public:
     
     void update()
     {
-        qrk::LockGuard guard(urg_mutex);
-        urg.capture(data, &timestamp);
+        if (threaded) {
+            frame_new = frames.update();
+            return;
+        }
         
-        vector<float> angles;
-        for (int i=0; i<data.size(); i++) {
-            angles.push_back( urg.index2rad(i));
+        // keeps the last scan while the device is recovering
+        frame_new = captureFrame(next_data);
+        if (frame_new) {
+            qrk::LockGuard guard(urg_mutex);
+            urg_data.swap(next_data);
         }
+    }
+    
+    // worker thread: fills the back slot and publishes it
+    bool captureThreaded()
+    {
+        if (!captureFrame(frames.back())) {
+            return false;
+        }
+        frames.publish();
+        return true;
+    }
+    
+    // captures into the slot, reusing its scan unless a snapshot still refers to it.
+    // urg_mutex is only locked after the sensor answered, so that the setters
+    // do not wait for the round trip of the manual capture.
+    bool captureFrame(ofPtr<ofxUrg::UrgData>& slot)
+    {
+        if (!slot || !slot.unique()) {
+            slot = ofPtr<ofxUrg::UrgData>(new ofxUrg::UrgData);
+        }
+        ofxUrg::UrgData& frame = *slot;
+        vector<long>& intensity = frame.getIntensityRef();
+        {
+            qrk::LockGuard guard(capture_mutex);
+            if (capture_mode == IntensityCapture) {
+                if (urg.captureWithIntensity(frame.getDataRef(), intensity, &timestamp) <= 0) {
+                    return false;
+                }
+            } else {
+                intensity.clear();
+                if (urg.capture(frame.getDataRef(), &timestamp) <= 0) {
+                    return false;
+                }
+            }
+        }
+        
+        qrk::LockGuard guard(urg_mutex);
+        temporal_filter.apply(frame.getDataRef(), urg.minDistance());
         
-        urg_data.setData(data);
-        urg_data.setDataAngles(angles);
+        vector<long> const& captured = frame.getDataRef();
+        if (!intensity.empty()) {
+            intensity.resize(captured.size(), 0);
+        }
+        if (!angle_table || angle_table->size() != captured.size()) {
+            updateAngleTable(captured.size());
+        }
+        frame.setAngleTable(angle_table);
+        frame.updateValidMask(urg.minDistance(), urg.maxDistance());
+        if (bOutlierFilter) {
+            outlier_filter.apply(frame);
+        }
+        applyGate(frame);
+        frame.setTimestamp(ticks());
+        frame.setReflectorThreshold(reflector_threshold);
+        // snapshots are read from several places without a lock,
+        // so the lazy cartesian view is filled before sharing
+        frame.getXsRef();
+        return true;
+    }
+    
+    void setThreaded(bool on)
+    {
+        if (on == threaded) {
+            return;
+        }
         
+        if (on) {
+            threaded = true;
+            worker.startThread(true, false);
+        } else {
+            worker.waitForThread(true);
+            threaded = false;
+        }
+        frame_new = false;
+    }
+    
+    void setCaptureMode(RangeCaptureMode mode)
+    {
+        qrk::LockGuard guard(urg_mutex);
+        qrk::LockGuard device_guard(capture_mutex);
+        capture_mode = mode;
+        urg.setCaptureMode(mode);
+    }
+    
+    inline RangeCaptureMode getCaptureMode() const { return capture_mode; }
+    
+    void setShortRange(bool on)
+    {
+        qrk::LockGuard guard(urg_mutex);
+        short_range = on ? 1 : 0;
+        applyDataByte();
+    }
+    
+    inline bool isShortRange() const
+    {
+        if (short_range < 0) {
+            return urg.isConnected() && urg.maxDistance() <= MaxShortRange;
+        }
+        return short_range > 0;
+    }
+    
+    void setCaptureRange(int begin_index, int end_index)
+    {
+        qrk::LockGuard guard(urg_mutex);
+        capture_begin = begin_index;
+        capture_end = end_index;
+        applyCaptureSettings();
+    }
+    
+    void setCaptureSkipLines(int skip_lines)
+    {
+        qrk::LockGuard guard(urg_mutex);
+        capture_skip_lines = max(skip_lines, 1);
+        applyCaptureSettings();
+    }
+    
+    void setCaptureFrameInterval(int interval)
+    {
+        qrk::LockGuard guard(urg_mutex);
+        capture_frame_interval = max(interval, 0);
+        applyCaptureSettings();
+    }
+    
+    // called with urg_mutex locked
+    void applyCaptureSettings()
+    {
+        if (!urg.isConnected()) {
+            // applied by connect()
+            return;
+        }
+        RangeSensorParameter parameter = urg.parameter();
+        int begin = capture_begin < 0 ? parameter.area_min : max(capture_begin, parameter.area_min);
+        int end = capture_end < 0 ? parameter.area_max : min(capture_end, parameter.area_max);
+        qrk::LockGuard device_guard(capture_mutex);
+        urg.reconfigureCapture(begin, max(begin, end), capture_skip_lines, capture_frame_interval);
+    }
+    
+    // called with urg_mutex locked
+    void applyDataByte()
+    {
+        if (!urg.isConnected()) {
+            return;
+        }
+        qrk::LockGuard device_guard(capture_mutex);
+        urg.setCaptureDataByte(isShortRange() ? 2 : 3);
+    }
+    
+    // called with urg_mutex locked
+    void applyGate(ofxUrg::UrgData& frame)
+    {
+        if (!bNearThresh && !bFarThresh && !bAngleWindow) {
+            return;
+        }
+        long near_distance = bNearThresh ? near_thresh : LONG_MIN;
+        long far_distance = bFarThresh ? far_thresh : LONG_MAX;
+        int first_index = 0;
+        int last_index = INT_MAX;
+        if (bAngleWindow) {
+            first_index = urg.rad2index(ofDegToRad(min_angle));
+            last_index = urg.rad2index(ofDegToRad(max_angle));
+        }
+        frame.applyGate(near_distance, far_distance, first_index, last_index);
+    }
+    
+    void setNearThreshold(bool enable, long distance)
+    {
+        qrk::LockGuard guard(urg_mutex);
+        bNearThresh = enable;
+        near_thresh = distance;
+    }
+    
+    void setFarThreshold(bool enable, long distance)
+    {
+        qrk::LockGuard guard(urg_mutex);
+        bFarThresh = enable;
+        far_thresh = distance;
+    }
+    
+    void setAngleWindow(bool enable, float min_degree, float max_degree)
+    {
+        qrk::LockGuard guard(urg_mutex);
+        bAngleWindow = enable;
+        min_angle = min_degree;
+        max_angle = max_degree;
+    }
+    
+    void setOutlierFilter(bool enable, float min_angle, int window, float isolated_distance)
+    {
+        qrk::LockGuard guard(urg_mutex);
+        bOutlierFilter = enable;
+        outlier_filter.setup(min_angle, window, isolated_distance);
+    }
+    
+    void setReflectorThreshold(long threshold)
+    {
+        qrk::LockGuard guard(urg_mutex);
+        reflector_threshold = threshold;
+    }
+    
+    void setTemporalFilter(ofxUrg::TemporalFilter::Mode mode, int window, float alpha, long hysteresis, long jump)
+    {
+        qrk::LockGuard guard(urg_mutex);
+        temporal_filter.setup(mode, window, alpha, hysteresis, jump);
     }
     
+    inline bool isThreaded() const { return threaded; }
+    inline bool isFrameNew() const { return frame_new; }
+    
+    // the scan read by the main thread
+    inline ofxUrg::UrgDataPtr current() const { return threaded ? frames.front() : urg_data; }
+    
     void draw(float x, float y) const
     {
         ofPushStyle();
         ofNoFill();
-        urg_data.draw(x, y);
+        current()->draw(x, y);
         ofPopStyle();
     }
     
-    void connect()
+    bool connect()
     {
         qrk::LockGuard guard(urg_mutex);
         
-        if (! urg.connect(device.c_str())) {
-            printf("UrgDevice::connect: %s\n", urg.what());
-            exit(1);
+        {
+            qrk::LockGuard device_guard(capture_mutex);
+            if (! urg.connect(device.c_str())) {
+                ofLogError("ofxUrgDevice") << "connect: " << urg.what();
+                return false;
+            }
         }
+        // the parameter was loaded again
+        angle_table.reset();
+        temporal_filter.reset();
+        applyDataByte();
+        applyCaptureSettings();
+        return true;
+    }
+    
+    // shares the angle, cos and sin tables of UrgDevice with every frame
+    void updateAngleTable(size_t data_size)
+    {
+        int n = min(data_size, urg.angleTableSize());
+        angle_table = ofxUrg::AngleTablePtr(new ofxUrg::AngleTable);
+        angle_table->setTables(urg.angleTable(), urg.cosTable(), urg.sinTable(), n, sensor_angle);
     }
     
     void disconnect()
     {
+        qrk::LockGuard guard(urg_mutex);
+        qrk::LockGuard device_guard(capture_mutex);
         urg.disconnect();
     }
     
+    inline bool isConnected() const { return urg.isConnected(); }
+    
     inline vector<string> getDevices() const { return devices; }
-    inline ofxUrg::UrgData getData() const { return urg_data; }
+    inline ofxUrg::UrgData getData() const { return *current(); }
+    inline ofxUrg::UrgDataPtr getSnapshot() const { return current(); }
     inline long minDistance() const { return urg.minDistance(); }
     inline long maxDistance() const { return urg.maxDistance(); }
     inline int maxScanIndex() const { return urg.maxScanLines(); }
@@ -144,9 +442,35 @@ public:
     
     void setSensorAngle(float degree)
     {
-        urg_data.setSensorAngle(degree);
+        {
+            // called every frame by the app, and must not wait for a capture
+            qrk::LockGuard guard(angle_mutex);
+            if (angle_applied && degree == applied_angle) {
+                return;
+            }
+        }
+        qrk::LockGuard guard(urg_mutex);
+        {
+            qrk::LockGuard angle_guard(angle_mutex);
+            applied_angle = degree;
+            angle_applied = true;
+        }
+        sensor_angle = degree;
+        urg.setAngleOffset(ofDegToRad(degree + 90));
+        angle_table.reset();
+        if (!threaded) {
+            // rotates a copy, the shared snapshot is immutable
+            ofPtr<ofxUrg::UrgData> rotated(new ofxUrg::UrgData(*urg_data));
+            rotated->setSensorAngle(degree);
+            rotated->getXsRef();
+            urg_data = rotated;
+        }
     }
     
+    inline void setLatencyMeasurement(bool on) { urg.setLatencyMeasurement(on); }
+    inline CaptureLatency getLatency() const { return urg.latency(); }
+    inline CaptureStatistics getStatistics() const { return urg.statistics(); }
+    
     void drawCoordinate(float x, float y) const
     {
         ofPushStyle();
@@ -166,6 +490,7 @@ ofxUrgDevice::ofxUrgDevice() : pImpl(new Impl)
 
 ofxUrgDevice::~ofxUrgDevice()
 {
+    delete pImpl;
 }
 
 void ofxUrgDevice::setup()
@@ -193,9 +518,9 @@ void ofxUrgDevice::drawCoordinate(float x, float y) const
     pImpl->drawCoordinate(x, y);
 }
 
-void ofxUrgDevice::connect()
+bool ofxUrgDevice::connect()
 {
-    pImpl->connect();
+    return pImpl->connect();
 }
 
 void ofxUrgDevice::disconnect()
@@ -203,11 +528,112 @@ void ofxUrgDevice::disconnect()
     pImpl->disconnect();
 }
 
+bool ofxUrgDevice::isConnected() const
+{
+    return pImpl->isConnected();
+}
+
 void ofxUrgDevice::setSensorAngle(float degree)
 {
     pImpl->setSensorAngle(degree);
 }
 
+void ofxUrgDevice::setCaptureMode(qrk::RangeCaptureMode mode)
+{
+    pImpl->setCaptureMode(mode);
+}
+
+qrk::RangeCaptureMode ofxUrgDevice::getCaptureMode() const
+{
+    return pImpl->getCaptureMode();
+}
+
+void ofxUrgDevice::setShortRange(bool short_range)
+{
+    pImpl->setShortRange(short_range);
+}
+
+bool ofxUrgDevice::isShortRange() const
+{
+    return pImpl->isShortRange();
+}
+
+void ofxUrgDevice::setCaptureRange(int begin_index, int end_index)
+{
+    pImpl->setCaptureRange(begin_index, end_index);
+}
+
+void ofxUrgDevice::setCaptureSkipLines(int skip_lines)
+{
+    pImpl->setCaptureSkipLines(skip_lines);
+}
+
+void ofxUrgDevice::setCaptureFrameInterval(int interval)
+{
+    pImpl->setCaptureFrameInterval(interval);
+}
+
+void ofxUrgDevice::setNearThreshold(bool enable, long distance)
+{
+    pImpl->setNearThreshold(enable, distance);
+}
+
+void ofxUrgDevice::setFarThreshold(bool enable, long distance)
+{
+    pImpl->setFarThreshold(enable, distance);
+}
+
+void ofxUrgDevice::setAngleWindow(bool enable, float min_degree, float max_degree)
+{
+    pImpl->setAngleWindow(enable, min_degree, max_degree);
+}
+
+void ofxUrgDevice::setOutlierFilter(bool enable, float min_angle, int window, float isolated_distance)
+{
+    pImpl->setOutlierFilter(enable, min_angle, window, isolated_distance);
+}
+
+void ofxUrgDevice::setReflectorThreshold(long threshold)
+{
+    pImpl->setReflectorThreshold(threshold);
+}
+
+void ofxUrgDevice::setTemporalFilter(ofxUrg::TemporalFilter::Mode mode, int window, float alpha,
+                                     long hysteresis, long jump)
+{
+    pImpl->setTemporalFilter(mode, window, alpha, hysteresis, jump);
+}
+
+void ofxUrgDevice::setThreaded(bool threaded)
+{
+    pImpl->setThreaded(threaded);
+}
+
+bool ofxUrgDevice::isThreaded() const
+{
+    return pImpl->isThreaded();
+}
+
+bool ofxUrgDevice::isFrameNew() const
+{
+    return pImpl->isFrameNew();
+}
+
+void ofxUrgDevice::setLatencyMeasurement(bool on)
+{
+    pImpl->setLatencyMeasurement(on);
+}
+
+qrk::CaptureLatency ofxUrgDevice::getLatency() const
+{
+    return pImpl->getLatency();
+}
+
+qrk::CaptureStatistics ofxUrgDevice::getStatistics() const
+{
+    return pImpl->getStatistics();
+}
+
 vector<std::string> ofxUrgDevice::getDevices() const
 {
     return pImpl->getDevices();
@@ -218,6 +644,11 @@ ofxUrg::UrgData ofxUrgDevice::getData() const
     return pImpl->getData();
 }
 
+ofxUrg::UrgDataPtr ofxUrgDevice::getSnapshot() const
+{
+    return pImpl->getSnapshot();
+}
+
 long ofxUrgDevice::minDistance() const
 {
     return pImpl->minDistance();
@@ -1,6 +1,14 @@
+#ifndef __example_ofxUrgDevice__ofxUrgDevice__
+#define __example_ofxUrgDevice__ofxUrgDevice__
+
 #include <memory>
 #include <vector>
 #include "UrgData.h"
+#include "TemporalFilter.h"
+#include "OutlierFilter.h"
+#include "CaptureLatency.h"
+#include "CaptureStatistics.h"
+#include "RangeCaptureMode.h"
 
 using std::vector;
 
@@ -15,13 +23,69 @@ public:
     void update();
     void draw(float x, float y) const;
     void drawCoordinate(float x, float y) const;
-    void connect();
+    bool connect();
     void disconnect();
+    bool isConnected() const;
     
     void setSensorAngle(float degree);
     
+    // AutoCapture (MD/MS streaming, default), ManualCapture (GD/GS request per update)
+    // or IntensityCapture (ME)
+    void setCaptureMode(qrk::RangeCaptureMode mode);
+    qrk::RangeCaptureMode getCaptureMode() const;
+    
+    // 2 byte encoding (GS/MS): 2/3 of the traffic, distances up to 4095 mm.
+    // enabled by default on models whose max distance fits.
+    void setShortRange(bool short_range);
+    bool isShortRange() const;
+    
+    // ROI in sensor indices, -1 for the full range of the model.
+    // applied at the next scan boundary without stopping the stream.
+    void setCaptureRange(int begin_index, int end_index);
+    // merges each skip_lines beams into one (the nearest is returned)
+    void setCaptureSkipLines(int skip_lines);
+    // captures one of each (interval + 1) scans
+    void setCaptureFrameInterval(int interval);
+    
+    // gating: beams nearer than near, farther than far, or out of the
+    // angular window [degree, 0 is the front of the sensor] are marked
+    // invalid, and UrgData::getValidIndicesRef() lists the rest
+    void setNearThreshold(bool enable, long distance = 0);
+    void setFarThreshold(bool enable, long distance = 4000);
+    void setAngleWindow(bool enable, float min_degree = -180, float max_degree = 180);
+    
+    // marks veiling (mixed pixel) and isolated beams invalid before gating,
+    // see ofxUrg::OutlierFilter
+    void setOutlierFilter(bool enable, float min_angle = 10, int window = 1, float isolated_distance = 100);
+    
+    // with IntensityCapture, beams at or above the threshold are marked in
+    // UrgData::getReflectorMaskRef() of each new scan
+    void setReflectorThreshold(long threshold);
+    
+    // smooths each beam over the last scans before gating, see ofxUrg::TemporalFilter.
+    // None (default), Median of window scans, or Exponential average.
+    void setTemporalFilter(ofxUrg::TemporalFilter::Mode mode, int window = 3, float alpha = 0.5,
+                           long hysteresis = 0, long jump = 100);
+    
+    // captures on a background thread, so that update() only picks up
+    // the latest complete scan instead of waiting for the sensor
+    void setThreaded(bool threaded);
+    bool isThreaded() const;
+    bool isFrameNew() const;
+    
+    void setLatencyMeasurement(bool on);
+    qrk::CaptureLatency getLatency() const;
+    
+    // counters since connect(); diff two snapshots for a rate
+    qrk::CaptureStatistics getStatistics() const;
+    
     std::vector<std::string> getDevices() const;
+    // deep copy of the latest scan
     ofxUrg::UrgData getData() const;
+    // the latest scan shared by reference count. it is never modified, and
+    // stays valid while held even after new scans arrive, so it can be passed
+    // to other threads. call it from the thread calling update().
+    ofxUrg::UrgDataPtr getSnapshot() const;
     long minDistance() const;
     long maxDistance() const;
     int maxScanIndex() const;
@@ -29,8 +93,14 @@ public:
     double index2rad(const int index) const;
     
 private:
+    // owns the sensor thread and connection
+    ofxUrgDevice(ofxUrgDevice const&);
+    ofxUrgDevice& operator=(ofxUrgDevice const&);
+    
     struct Impl;
 //    std::auto_ptr<Impl> pImpl;
     Impl* pImpl;
     
 };
+
+#endif /* defined(__example_ofxUrgDevice__ofxUrgDevice__) */
@@ -0,0 +1,187 @@
+//
+//  ofxUrgManager.cpp
+//  example_ofxUrgDevice
+//
+//
+
+#include "ofxUrgManager.h"
+#include "ScanMatcher.h"
+
+using namespace ofxUrg;
+
+namespace {
+    
+    // connection takes about a second per sensor for the baudrate detection,
+    // so that every sensor is connected on its own thread
+    struct Connector : public ofThread
+    {
+        ofxUrgDevice* sensor;
+        string device;
+        bool connected;
+        
+        Connector() : sensor(NULL), connected(false) {}
+        
+        void threadedFunction()
+        {
+            sensor->setup(device);
+            connected = sensor->isConnected();
+        }
+    };
+    
+}
+
+ofxUrgManager::ofxUrgManager()
+:max_skew(200), frame_new(false)
+{}
+
+ofxUrgManager::~ofxUrgManager()
+{
+    clear();
+}
+
+int ofxUrgManager::setup()
+{
+    ofxUrgDevice finder;
+    return setup(finder.getDevices());
+}
+
+int ofxUrgManager::setup(vector<string> const& devices)
+{
+    // disconnects the sensors of the previous setup()
+    clear();
+    
+    vector<Connector*> connectors;
+    for (int i=0; i<devices.size(); i++) {
+        Connector* connector = new Connector;
+        connector->sensor = new ofxUrgDevice;
+        connector->device = devices[i];
+        connector->startThread(true, false);
+        connectors.push_back(connector);
+    }
+    
+    int n = 0;
+    for (int i=0; i<connectors.size(); i++) {
+        Connector* connector = connectors[i];
+        connector->waitForThread(false);
+        if (connector->connected) {
+            connector->sensor->setThreaded(true);
+            connector->sensor->setSensorAngle(0);
+            sensors.push_back(connector->sensor);
+            poses.push_back(SensorPose());
+            snapshots.push_back(connector->sensor->getSnapshot());
+            n++;
+        } else {
+            ofLogError("ofxUrgManager") << "setup: " << devices[i] << " is not connected";
+            delete connector->sensor;
+        }
+        delete connector;
+    }
+    return n;
+}
+
+int ofxUrgManager::addSensor(string const& device, SensorPose const& pose)
+{
+    ofxUrgDevice* sensor = new ofxUrgDevice;
+    sensor->setup(device);
+    if (!sensor->isConnected()) {
+        delete sensor;
+        return -1;
+    }
+    sensor->setThreaded(true);
+    sensors.push_back(sensor);
+    poses.push_back(pose);
+    snapshots.push_back(sensor->getSnapshot());
+    sensor->setSensorAngle(pose.angle);
+    return sensors.size() - 1;
+}
+
+void ofxUrgManager::clear()
+{
+    for (int i=0; i<sensors.size(); i++) {
+        delete sensors[i];
+    }
+    sensors.clear();
+    poses.clear();
+    snapshots.clear();
+    points.clear();
+    sources.clear();
+}
+
+void ofxUrgManager::setPose(int i, SensorPose const& pose)
+{
+    poses[i] = pose;
+    sensors[i]->setSensorAngle(pose.angle);
+}
+
+bool ofxUrgManager::calibrate(int i, int reference)
+{
+    if (i == reference || snapshots[i]->size() <= 0 || snapshots[reference]->size() <= 0) {
+        return false;
+    }
+    ScanMatcher matcher;
+    matcher.setReference(*snapshots[reference], poses[reference]);
+    if (!matcher.match(*snapshots[i], poses[i])) {
+        return false;
+    }
+    setPose(i, matcher.getPose());
+    return true;
+}
+
+void ofxUrgManager::update()
+{
+    // each sensor captures on its own thread, update() only swaps buffers
+    frame_new = false;
+    for (int i=0; i<sensors.size(); i++) {
+        sensors[i]->update();
+        if (sensors[i]->isFrameNew()) {
+            snapshots[i] = sensors[i]->getSnapshot();
+            frame_new = true;
+        }
+    }
+    
+    if (frame_new) {
+        merge();
+    }
+}
+
+void ofxUrgManager::merge()
+{
+    long newest = 0;
+    int total = 0;
+    for (int i=0; i<snapshots.size(); i++) {
+        newest = max(newest, snapshots[i]->getTimestamp());
+        total += snapshots[i]->getDataRef().size();
+    }
+    
+    points.clear();
+    sources.clear();
+    points.reserve(total);
+    sources.reserve(total);
+    for (int i=0; i<snapshots.size(); i++) {
+        UrgData const& scan = *snapshots[i];
+        // only rejects stale scans, the others are merged as they are
+        if (newest - scan.getTimestamp() > max_skew || scan.size() <= 0) {
+            continue;
+        }
+        
+        // the rotation of the pose is already applied by setSensorAngle()
+        vector<float> const& xs = scan.getXsRef();
+        vector<float> const& ys = scan.getYsRef();
+        vector<int> const& survivors = scan.getValidIndicesRef();
+        for (int k=0; k<survivors.size(); k++) {
+            int j = survivors[k];
+            points.push_back(ofVec2f(xs[j] + poses[i].x, ys[j] + poses[i].y));
+            sources.push_back(i);
+        }
+    }
+}
+
+void ofxUrgManager::draw(float x, float y) const
+{
+    ofPushStyle();
+    for (int i=0; i<sensors.size(); i++) {
+        ofSetColor(ofColor::fromHsb((i*60 + 40) % 256, 255, 255));
+        sensors[i]->draw(x + poses[i].x, y + poses[i].y);
+    }
+    ofPopStyle();
+}
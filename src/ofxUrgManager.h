@@ -0,0 +1,69 @@
+//
+//  ofxUrgManager.h
+//  example_ofxUrgDevice
+//
+//
+
+#ifndef __example_ofxUrgDevice__ofxUrgManager__
+#define __example_ofxUrgDevice__ofxUrgManager__
+
+#include "ofxUrgDevice.h"
+#include "SensorPose.h"
+
+// runs several sensors in parallel and merges their scans in world coordinates
+class ofxUrgManager
+{
+public:
+    ofxUrgManager();
+    ~ofxUrgManager();
+    
+    // connects every discovered sensor at the same time, in place of the
+    // sensors connected before. returns the number of connected sensors.
+    int setup();
+    int setup(vector<string> const& devices);
+    // returns the index of the sensor, or -1 when the connection failed
+    int addSensor(string const& device, ofxUrg::SensorPose const& pose = ofxUrg::SensorPose());
+    void clear();
+    
+    // picks up the latest scan of each sensor and merges them
+    void update();
+    void draw(float x, float y) const;
+    bool isFrameNew() const { return frame_new; }
+    
+    int size() const { return sensors.size(); }
+    ofxUrgDevice& getSensor(int i) { return *sensors[i]; }
+    void setPose(int i, ofxUrg::SensorPose const& pose);
+    ofxUrg::SensorPose const& getPose(int i) const { return poses[i]; }
+    // corrects the pose of sensor i by matching its latest scan to the scan
+    // of the reference sensor (see ofxUrg::ScanMatcher). both poses should be
+    // roughly right already. returns false when the scans do not overlap.
+    bool calibrate(int i, int reference);
+    
+    // scans older than the newest one by more than max_skew are left out
+    // of the merged points, e.g. while a sensor is reconnecting [msec].
+    // the scans are not aligned in time: the merged points mix the latest
+    // scan of each sensor, up to max_skew apart.
+    void setMaxSkew(long msec) { max_skew = msec; }
+    
+    // merged valid beams in world coordinates [mm], and the sensor of each point
+    vector<ofVec2f> const& getPointsRef() const { return points; }
+    vector<int> const& getSourcesRef() const { return sources; }
+    // the scans merged by the last update()
+    ofxUrg::UrgDataPtr getSnapshot(int i) const { return snapshots[i]; }
+    
+private:
+    ofxUrgManager(ofxUrgManager const&);
+    ofxUrgManager& operator=(ofxUrgManager const&);
+    
+    void merge();
+    
+    vector<ofxUrgDevice*> sensors;
+    vector<ofxUrg::SensorPose> poses;
+    vector<ofxUrg::UrgDataPtr> snapshots;
+    vector<ofVec2f> points;
+    vector<int> sources;
+    long max_skew;
+    bool frame_new;
+};
+
+#endif /* defined(__example_ofxUrgDevice__ofxUrgManager__) */